@@ -0,0 +1,86 @@
+#include <Arduino.h>
+#include <EasyHelpers.h>
+#include <SPIFFS.h>
+
+enum class EventID { NewMessage, EVENT_1 };
+
+//! Send JSON messages in batches, one transport write per batch instead of
+//! one per message.
+
+class Uplink : public Helpers::BatchedEvent<EventID> {
+   public:
+    //* Up to 512 bytes or 8 messages, and no message waits more than 50 ms
+    Uplink() : BatchedEvent({512, 8, 50, Helpers::FRAMING_NDJSON}) {}
+
+    //* Receives whole batches, the receiver splits them with deserializeBatch
+    void sendBinary(const uint8_t* data, size_t length) override {
+        Serial.printf("Batch of %u bytes:\n%.*s", length, (int)length, data);
+    }
+};
+
+class Manager : public Helpers::CustomEventManager<EventID> {
+   public:
+    Manager() : CustomEventManager("Manager") {}
+    void update(const EventID& event) override {}
+};
+
+auto manager = std::make_shared<Manager>();
+auto uplink = std::make_shared<Uplink>();
+
+//* Everything the uplink sends is also appended to a file, opened once
+//* SPIFFS is mounted
+std::unique_ptr<Helpers::FileSink> archive;
+std::unique_ptr<Helpers::MessageBatcher> archiver;
+
+void setup() {
+    Serial.begin(115200);
+    delay(1000);
+    manager->addSubscriber(uplink);
+
+    if (!SPIFFS.begin(true)) {
+        Serial.println("SPIFFS mount failed, not archiving");
+        return;
+    }
+    archive.reset(new Helpers::FileSink("/spiffs/outbound.ndjson"));
+    if (!archive->good()) {
+        Serial.println("Could not open the archive, not archiving");
+        archive.reset();
+        return;
+    }
+    archiver.reset(new Helpers::MessageBatcher(*archive, {4096, 64, 1000}));
+}
+
+void loop() {
+    JsonDocument reading;
+    reading["sensor"] = "boiler";
+    reading["temp"] = 20 + (millis() / 100) % 10;
+    uplink->sendMessage(reading);
+    if (archiver) {
+        archiver->add(reading);
+    }
+
+    //* Flushes batches whose linger has expired
+    manager->handleStrategies();
+    if (archiver) {
+        archiver->poll();
+    }
+
+    static uint32_t lastReport = 0;
+    if (millis() - lastReport > 5000) {
+        lastReport = millis();
+        Helpers::BatchStats stats = uplink->getBatchStats();
+        Serial.printf(
+            "%llu messages in %llu batches (%.1f per batch, largest %u "
+            "bytes): %llu by size, %llu by count, %llu by linger\n",
+            (unsigned long long)stats.messages,
+            (unsigned long long)stats.batches, stats.messagesPerBatch(),
+            stats.largestBatch, (unsigned long long)stats.bySize,
+            (unsigned long long)stats.byCount,
+            (unsigned long long)stats.byLinger);
+        if (archiver) {
+            Serial.printf("Archive: %llu batches failed to write\n",
+                          (unsigned long long)archiver->getStats().failed);
+        }
+    }
+    delay(10);
+}
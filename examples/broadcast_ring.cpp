@@ -0,0 +1,74 @@
+#include <Arduino.h>
+#include <EasyHelpers.h>
+
+enum class EventID { NewMessage, EVENT_1 };
+
+//! Strategies sharing one stream through a BroadcastRing, against copying
+//! every message into each strategy's MessageBuffer.
+
+Helpers::BroadcastRing<JsonDocument> ring(64);
+
+class Display : public Helpers::IEvent<EventID> {
+    Helpers::BroadcastRing<JsonDocument>::Consumer stream = ring.subscribe();
+
+   public:
+    float total = 0;
+
+    void receiveMessage() override {
+        //* Read in place, the ring keeps the only copy
+        stream.poll([this](const JsonDocument& message, uint32_t) {
+            total += message["temp"].as<float>();
+        });
+    }
+};
+
+constexpr size_t NUM_STRATEGIES = 4;
+constexpr size_t NUM_MESSAGES = 1000;
+
+void setup() {
+    Serial.begin(115200);
+    delay(1000);
+
+    JsonDocument message;
+    message["sensor"] = "kitchen";
+    message["temp"] = 21.5;
+
+    std::vector<std::shared_ptr<Display> > displays;
+    for (size_t i = 0; i < NUM_STRATEGIES; i++) {
+        displays.push_back(std::make_shared<Display>());
+    }
+
+    //* One copy per strategy
+    uint32_t start = micros();
+    for (size_t i = 0; i < NUM_MESSAGES; i++) {
+        for (auto& display : displays) {
+            display->addMessage(message);
+        }
+        for (auto& display : displays) {
+            display->getMessage();
+        }
+    }
+    uint32_t copied = micros() - start;
+
+    //* One copy in the ring, read by every strategy
+    start = micros();
+    for (size_t i = 0; i < NUM_MESSAGES; i++) {
+        ring.publish(message);
+        for (auto& display : displays) {
+            display->receiveMessage();
+        }
+    }
+    uint32_t shared = micros() - start;
+
+    Serial.printf("Per message: copies %.2f us, ring %.2f us\n",
+                  float(copied) / NUM_MESSAGES, float(shared) / NUM_MESSAGES);
+
+    for (const auto& consumer : ring.lagMetrics()) {
+        Serial.printf("Consumer %u: lag %llu, peak %llu, read %llu\n",
+                      consumer.slot, (unsigned long long)consumer.lag,
+                      (unsigned long long)consumer.peakLag,
+                      (unsigned long long)consumer.consumed);
+    }
+}
+
+void loop() {}
@@ -2,6 +2,7 @@
 #include <EasyHelpers.h>
 
 enum class EventID { EVENT_1, EVENT_2 };
+EASYHELPERS_REFLECT_ENUM(EventID, EVENT_1, EVENT_2);
 
 //! Very basic example of the CustomEventManager.
 
@@ -84,16 +85,8 @@ class EventManager : public Helpers::CustomEventManager<EventID> {
     }
 
     void update(const EventID& event) override {
-        switch (event) {
-            case EventID::EVENT_1:
-                this->log("Event 1 Received");
-                break;
-            case EventID::EVENT_2:
-                this->log("Event 2 Received");
-                break;
-            default:
-                break;
-        }
+        //* Event names come from the compile-time reflection of EventID
+        this->log(Helpers::enumName(event), " Received");
     }
 };
 
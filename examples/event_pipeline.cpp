@@ -0,0 +1,84 @@
+#include <Arduino.h>
+#include <EasyHelpers.h>
+
+enum class EventID { NewMessage, EVENT_1 };
+
+//! Parse, filter, enrich and send as pipeline stages, each on its own task.
+
+class Parse : public Helpers::PipelineStage<EventID> {
+   public:
+    void process(JsonDocument& message) override {
+        JsonDocument parsed;
+        if (!deserializeJson(parsed, message["raw"].as<const char*>())) {
+            emit(std::move(parsed));
+        }
+    }
+};
+
+class Filter : public Helpers::PipelineStage<EventID> {
+   public:
+    void process(JsonDocument& message) override {
+        //* Emitting nothing drops the message
+        if (message["temp"].as<float>() > 40) {
+            emit(std::move(message));
+        }
+    }
+};
+
+class Enrich : public Helpers::PipelineStage<EventID> {
+   public:
+    void process(JsonDocument& message) override {
+        message["alarm"] = true;
+        message["at"] = millis();
+        emit(std::move(message));
+    }
+};
+
+//* Any strategy can be a stage, messages left in its buffer are passed on
+class Send : public Helpers::IEvent<EventID> {
+   public:
+    void receiveMessage() override {
+        auto message = this->getMessage();
+        if (message) {
+            sendMessage(*message);
+        }
+    }
+
+    void sendMessage(const JsonDocument& message) override {
+        Serial.printf("Alarm at %lu\n", message["at"].as<unsigned long>());
+    }
+};
+
+Helpers::EventPipeline<EventID> pipeline(16);
+
+void setup() {
+    Serial.begin(115200);
+    delay(1000);
+
+    pipeline.addStage(std::make_shared<Parse>());
+    pipeline.addStage(std::make_shared<Filter>());
+    pipeline.addStage(std::make_shared<Enrich>());
+    pipeline.addStage(std::make_shared<Send>());
+    pipeline.start();
+}
+
+void loop() {
+    JsonDocument raw;
+    raw["raw"] = "{\"sensor\":\"boiler\",\"temp\":42.5}";
+    //* Waits while the first stage is full
+    pipeline.push(std::move(raw));
+
+    static uint32_t lastReport = 0;
+    if (millis() - lastReport > 5000) {
+        lastReport = millis();
+        for (const auto& stage : pipeline.stats()) {
+            Serial.printf(
+                "Stage %llu: %.0f msg/s, %.0f%% busy, queue %u/%u (peak %u), "
+                "%llu stalls\n",
+                (unsigned long long)stage.id, stage.messagesPerSecond,
+                stage.utilization * 100, stage.queueDepth, stage.capacity,
+                stage.peakDepth, (unsigned long long)stage.stalls);
+        }
+    }
+    delay(10);
+}
@@ -0,0 +1,82 @@
+#include <Arduino.h>
+#include <EasyHelpers.h>
+#include <sstream>
+
+enum class EventID { NewMessage, EVENT_1 };
+
+//! Record a session, then replay it at the original pace and flat out.
+
+class Sensor : public Helpers::IEvent<EventID> {
+   public:
+    size_t received = 0;
+
+    void receiveMessage() override {
+        while (this->getMessage()) {
+            received++;
+        }
+    }
+};
+
+class EventManager : public Helpers::CustomEventManager<EventID> {
+   public:
+    using Helpers::CustomEventManager<EventID>::CustomEventManager;
+
+    void update(const EventID& event) override {}
+};
+
+void printReport(const char* name, const Helpers::ReplayReport& report) {
+    Serial.printf(
+        "%s: %llu records in %.3f s, %.0f records/s, latency p50 %.1f us, "
+        "p99 %.1f us, p99.9 %.1f us, max %.1f us\n",
+        name, (unsigned long long)report.records, report.seconds,
+        report.recordsPerSecond, report.latencyP50, report.latencyP99,
+        report.latencyP999, report.latencyMax);
+}
+
+void setup() {
+    Serial.begin(115200);
+    delay(1000);
+
+    //* Record: every payload and notification goes to the stream
+    std::stringstream recording;
+    uint64_t recordedID;
+    {
+        auto manager = std::make_shared<EventManager>("Recorded");
+        auto sensor = std::make_shared<Sensor>();
+        manager->addSubscriber(sensor);
+        recordedID = sensor->getID();
+
+        Helpers::EventRecorder recorder(recording);
+        Helpers::EventRecorder::setActive(&recorder);
+        for (int i = 0; i < 200; i++) {
+            sensor->deserialize("{\"temp\":21.5}");
+            sensor->notifyAll(EventID::EVENT_1);
+            manager->handleStrategies();
+            delay(1);
+        }
+        Helpers::EventRecorder::setActive(nullptr);
+        Serial.printf("Recorded %llu records in %llu bytes\n",
+                      (unsigned long long)recorder.records(),
+                      (unsigned long long)recorder.bytes());
+    }
+
+    //* Replay into a manager driven by a virtual clock
+    Helpers::VirtualClock clock;
+    auto manager =
+        std::make_shared<EventManager>("Replayed", clock.millisClock());
+    auto sensor = std::make_shared<Sensor>();
+    manager->addSubscriber(sensor);
+    // records name their subject by ID, take over the recorded one
+    sensor->setID(recordedID);
+
+    Helpers::EventReplayer<EventID> replayer(*manager, clock);
+    std::stringstream paced(recording.str());
+    Helpers::RecordingReader pacedReader(paced);
+    printReport("Original pace", replayer.replay(pacedReader, 1.0));
+
+    std::stringstream fast(recording.str());
+    Helpers::RecordingReader fastReader(fast);
+    printReport("As fast as possible", replayer.replay(fastReader, 0));
+}
+
+void loop() {}
@@ -0,0 +1,54 @@
+#include <Arduino.h>
+#include <EasyHelpers.h>
+
+enum class EventID { NewMessage, EVENT_1 };
+
+//! Filter, project and aggregate the whole MessageBuffer with compiled
+//! queries, instead of getMessageByKey and nested lookups.
+
+class Monitor : public Helpers::IEvent<EventID> {
+    //* Compiled once, evaluated against every message
+    Helpers::JsonQuery hot{"sensors[*].temp > 40"};
+    Helpers::JsonQuery celsius{"unit == 'C' && !maintenance"};
+    Helpers::JsonQuery temperatures{"sensors[*].temp"};
+
+   public:
+    void receiveMessage() override {
+        //* Views into the buffered messages, nothing is copied
+        for (JsonVariantConst message : hot.filter(this->messages())) {
+            Serial.printf("Overheating: %s\n",
+                          message["device"].as<const char*>());
+        }
+
+        Helpers::JsonAggregate stats =
+            temperatures.aggregate(this->messages(), &celsius);
+        Serial.printf("%u readings, mean %.1f, max %.1f\n", stats.count,
+                      stats.mean(), stats.max);
+
+        this->clear();
+    }
+};
+
+Monitor monitor;
+
+void setup() {
+    Serial.begin(115200);
+    delay(1000);
+
+    Helpers::JsonQuery broken("sensors[*.temp");
+    if (!broken.valid()) {
+        Serial.printf("%s at %u\n", broken.getError().c_str(),
+                      broken.getErrorOffset());
+    }
+}
+
+void loop() {
+    monitor.deserialize(
+        "{\"device\":\"boiler\",\"unit\":\"C\",\"sensors\":[{\"temp\":38},"
+        "{\"temp\":44.5}]}");
+    monitor.deserialize(
+        "{\"device\":\"porch\",\"unit\":\"C\",\"maintenance\":true,"
+        "\"sensors\":[{\"temp\":12}]}");
+    monitor.receiveMessage();
+    delay(1000);
+}
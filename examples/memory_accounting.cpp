@@ -0,0 +1,57 @@
+#include <Arduino.h>
+#include <EasyHelpers.h>
+
+//! Attribute heap usage to subsystems, build with
+//! -DEASYHELPERS_MEMORY_ACCOUNTING=1.
+//!
+//! test/test_memory_accounting checks the accounting against malloc itself,
+//! run it on the host with `pio test -e native`.
+
+//* Over-aligned, allocated through the aligned operator new
+struct alignas(64) Cursor {
+    uint64_t position = 0;
+};
+
+//* Keeps its account, so its scopes skip the registry after the first
+class Sampler {
+    EASYHELPERS_MEMORY_ACCOUNT_CACHE(memory);
+    std::vector<float> samples;
+
+   public:
+    void sample(float value) {
+        EASYHELPERS_MEMORY_SCOPE_CACHED(memory, "Sampler", this);
+        samples.push_back(value);
+    }
+};
+
+Sampler sampler;
+
+void workload() {
+    EASYHELPERS_MEMORY_SCOPE("Sensors", "bme280");
+    std::vector<std::string> readings;
+    for (int i = 0; i < 32; i++) {
+        readings.push_back("temperature reading number " + std::to_string(i));
+    }
+    std::unique_ptr<Cursor> cursor(new Cursor());
+    auto* leaked = new std::vector<int>(100);  // still live after the scope
+    (void)leaked;
+}
+
+void setup() {
+    Serial.begin(115200);
+    delay(1000);
+
+    workload();
+    for (int i = 0; i < 100; i++) {
+        sampler.sample(i * 0.5f);
+    }
+
+    JsonDocument usage;
+    Helpers::memoryUsageJson(usage);
+    serializeJsonPretty(usage, Serial);
+    Serial.println();
+}
+
+void loop() {
+    delay(1000);
+}
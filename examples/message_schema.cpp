@@ -0,0 +1,101 @@
+#include <Arduino.h>
+#include <EasyHelpers.h>
+
+enum class EventID { NewMessage, EVENT_1 };
+
+//! Schema encoded messages, and their cost against JSON and MessagePack.
+
+struct Reading {
+    uint32_t id;
+    float temperature;
+    bool alarm;
+    std::string label;
+    std::vector<int16_t> samples;
+};
+EASYHELPERS_MESSAGE_SCHEMA(Reading, id, temperature, alarm, label, samples);
+
+class Radio : public Helpers::IEvent<EventID> {
+   public:
+    void sendBinary(const uint8_t*, size_t length) override {
+        Serial.printf("Sending %u bytes\n", length);
+    }
+};
+
+constexpr size_t NUM_ROUNDS = 1000;
+
+void benchmark(const Reading& reading) {
+    std::vector<uint8_t> encoded;
+    uint32_t start = micros();
+    for (size_t i = 0; i < NUM_ROUNDS; i++) {
+        Helpers::encodeMessage(reading, encoded);
+    }
+    uint32_t encodeTime = micros() - start;
+    Reading decoded;
+    start = micros();
+    for (size_t i = 0; i < NUM_ROUNDS; i++) {
+        Helpers::decodeMessage(encoded.data(), encoded.size(), decoded);
+    }
+    uint32_t decodeTime = micros() - start;
+    Serial.printf("Schema:      %3u bytes, encode %.2f us, decode %.2f us\n",
+                  encoded.size(), float(encodeTime) / NUM_ROUNDS,
+                  float(decodeTime) / NUM_ROUNDS);
+
+    JsonDocument doc = Helpers::toJsonDocument(reading);
+    char text[256];
+    size_t length = 0;
+    start = micros();
+    for (size_t i = 0; i < NUM_ROUNDS; i++) {
+        length = serializeJson(doc, text, sizeof(text));
+    }
+    encodeTime = micros() - start;
+    start = micros();
+    for (size_t i = 0; i < NUM_ROUNDS; i++) {
+        JsonDocument parsed;
+        deserializeJson(parsed, text, length);
+        Helpers::fromJsonDocument(parsed, decoded);
+    }
+    decodeTime = micros() - start;
+    Serial.printf("JSON:        %3u bytes, encode %.2f us, decode %.2f us\n",
+                  length, float(encodeTime) / NUM_ROUNDS,
+                  float(decodeTime) / NUM_ROUNDS);
+
+    start = micros();
+    for (size_t i = 0; i < NUM_ROUNDS; i++) {
+        length = serializeMsgPack(doc, text, sizeof(text));
+    }
+    encodeTime = micros() - start;
+    start = micros();
+    for (size_t i = 0; i < NUM_ROUNDS; i++) {
+        JsonDocument parsed;
+        deserializeMsgPack(parsed, text, length);
+        Helpers::fromJsonDocument(parsed, decoded);
+    }
+    decodeTime = micros() - start;
+    Serial.printf("MessagePack: %3u bytes, encode %.2f us, decode %.2f us\n",
+                  length, float(encodeTime) / NUM_ROUNDS,
+                  float(decodeTime) / NUM_ROUNDS);
+}
+
+void setup() {
+    Serial.begin(115200);
+    delay(1000);
+
+    Reading reading{42, 21.5f, false, "kitchen", {120, -4, 17, 3}};
+
+    //* Sent as a packed binary payload
+    Radio radio;
+    radio.sendEncoded(reading);
+
+    //* Received into the MessageBuffer as a JsonDocument
+    auto encoded = Helpers::encodeMessage(reading);
+    radio.deserializeBinary<Reading>(encoded.data(), encoded.size());
+    auto received = radio.getMessageAs<Reading>();
+    if (received) {
+        Serial.printf("Received %s: %.1f\n", received->label.c_str(),
+                      received->temperature);
+    }
+
+    benchmark(reading);
+}
+
+void loop() {}
@@ -0,0 +1,74 @@
+#include <Arduino.h>
+#include <EasyHelpers.h>
+
+enum class EventID { NewMessage, EVENT_1 };
+
+//! Start strategies in dependency order, independent ones at the same time,
+//! and leave rarely used ones until they are first needed.
+
+class Slow : public Helpers::IEvent<EventID> {
+    const char* name;
+    uint32_t initMs;
+
+   public:
+    Slow(const char* name, uint32_t initMs) : name(name), initMs(initMs) {}
+
+    //* Stands in for connecting, calibrating or loading a file. Strategies
+    //* may start concurrently, so this one leaves Serial alone
+    void begin() override {
+        delay(initMs);
+    }
+
+    const char* getName() const {
+        return name;
+    }
+};
+
+class Manager : public Helpers::CustomEventManager<EventID> {
+   public:
+    Manager() : CustomEventManager("Manager") {}
+    void update(const EventID& event) override {}
+};
+
+auto manager = std::make_shared<Manager>();
+auto wifi = std::make_shared<Slow>("WiFi", 300);
+auto sensors = std::make_shared<Slow>("Sensors", 200);
+auto config = std::make_shared<Slow>("Config", 100);
+auto mqtt = std::make_shared<Slow>("MQTT", 150);
+auto ota = std::make_shared<Slow>("OTA", 250);
+
+void setup() {
+    Serial.begin(115200);
+    delay(1000);
+
+    //* MQTT needs the network and its settings, sensors need neither
+    mqtt->dependsOn(*wifi);
+    mqtt->dependsOn(*config);
+    //* Started by the first handleStrategies instead of at boot
+    ota->deferrable = true;
+
+    for (auto strategy : {wifi, sensors, config, mqtt, ota}) {
+        manager->addSubscriber(strategy);
+    }
+
+    //* Up to 4 independent strategies start at once, in their own threads:
+    //* about 450 ms instead of the 750 ms of plain begin() starting them one
+    //* by one. The dependencies hold MQTT back until WiFi and Config are up
+    manager->begin(4);
+    Serial.printf("Started in %llu us\n",
+                  (unsigned long long)manager->getStartupMicros());
+    for (const auto& init : manager->getInitStats()) {
+        auto strategy =
+            std::static_pointer_cast<Slow>(manager->getStrategy(init.id));
+        Serial.printf("%s: %s, +%llu us, took %llu us\n",
+                      strategy->getName(),
+                      init.started ? "started" : "deferred",
+                      (unsigned long long)init.startOffset,
+                      (unsigned long long)init.micros);
+    }
+}
+
+void loop() {
+    manager->handleStrategies();
+    delay(10);
+}
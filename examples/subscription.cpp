@@ -0,0 +1,84 @@
+#include <Arduino.h>
+#include <EasyHelpers.h>
+
+enum class EventID { EVENT_1, EVENT_2 };
+
+//! Callback subscriptions, and their notify cost against IObserver.
+
+class Observer : public Helpers::IObserver<EventID> {
+   public:
+    uint32_t count = 0;
+
+    void update(const EventID& event) override {
+        count++;
+    }
+};
+
+class Subject : public Helpers::ISubject<EventID> {};
+
+constexpr size_t NUM_SUBSCRIBERS = 16;
+constexpr size_t NUM_ROUNDS = 10000;
+
+void benchmarkObservers() {
+    Subject subject;
+    std::vector<std::shared_ptr<Observer> > observers;
+    for (size_t i = 0; i < NUM_SUBSCRIBERS; i++) {
+        observers.push_back(std::make_shared<Observer>());
+        subject.attach(observers.back());
+    }
+
+    uint32_t start = micros();
+    for (size_t i = 0; i < NUM_ROUNDS; i++) {
+        subject.notifyAll(EventID::EVENT_1);
+    }
+    uint32_t elapsed = micros() - start;
+
+    Serial.printf("IObserver:    %.3f us per notifyAll (%u observers)\n",
+                  float(elapsed) / NUM_ROUNDS, NUM_SUBSCRIBERS);
+}
+
+void benchmarkSubscriptions() {
+    Subject subject;
+    uint32_t count = 0;
+    std::vector<Helpers::Subscription<EventID> > subscriptions;
+    for (size_t i = 0; i < NUM_SUBSCRIBERS; i++) {
+        subscriptions.push_back(
+            subject.subscribe([&count](const EventID& event) { count++; }));
+    }
+
+    uint32_t start = micros();
+    for (size_t i = 0; i < NUM_ROUNDS; i++) {
+        subject.notifyAll(EventID::EVENT_1);
+    }
+    uint32_t elapsed = micros() - start;
+
+    Serial.printf("Subscription: %.3f us per notifyAll (%u callbacks)\n",
+                  float(elapsed) / NUM_ROUNDS, NUM_SUBSCRIBERS);
+}
+
+void setup() {
+    Serial.begin(115200);
+    delay(1000);
+
+    Subject subject;
+
+    //* The subscription stays attached as long as the handle lives
+    auto subscription = subject.subscribe([](const EventID& event) {
+        Serial.printf("Event %d Received\n", static_cast<int>(event));
+    });
+    subject.notifyAll(EventID::EVENT_1);
+
+    //* Keyed subscriptions also receive notify() calls for their key
+    auto keyed = subject.subscribe(100, [](const EventID& event) {
+        Serial.println("Event for key 100 Received");
+    });
+    subject.notify(100, EventID::EVENT_2);
+
+    subscription.reset();
+    subject.notifyAll(EventID::EVENT_2);
+
+    benchmarkObservers();
+    benchmarkSubscriptions();
+}
+
+void loop() {}
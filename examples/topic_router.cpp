@@ -0,0 +1,104 @@
+#include <Arduino.h>
+#include <EasyHelpers.h>
+
+enum class EventID { NewMessage, EVENT_1 };
+
+//! Topic routing into strategies, and its cost against each strategy
+//! filtering every message itself.
+
+class Strategy : public Helpers::IEvent<EventID> {
+   public:
+    std::string filter;
+
+    explicit Strategy(const std::string& filter) : filter(filter) {}
+};
+
+constexpr size_t NUM_SUBSCRIPTIONS = 1000;
+constexpr size_t NUM_ROUNDS = 1000;
+
+// what each strategy does on its own without a router
+bool topicMatches(const std::string& filter, const std::string& topic) {
+    size_t f = 0;
+    size_t t = 0;
+    while (f < filter.size()) {
+        if (filter[f] == '#') {
+            return true;
+        }
+        if (filter[f] == '+') {
+            while (t < topic.size() && topic[t] != '/') {
+                t++;
+            }
+            f++;
+        } else if (t < topic.size() && filter[f] == topic[t]) {
+            f++;
+            t++;
+        } else {
+            return false;
+        }
+    }
+    return t == topic.size();
+}
+
+void benchmark() {
+    Helpers::TopicRouter<EventID> router;
+    std::vector<std::shared_ptr<Strategy> > strategies;
+    for (size_t i = 0; i < NUM_SUBSCRIPTIONS; i++) {
+        std::string filter = "site/" + std::to_string(i % 10) + "/device/" +
+                             std::to_string(i) + "/+";
+        strategies.push_back(std::make_shared<Strategy>(filter));
+        router.subscribe(filter, strategies.back());
+    }
+
+    std::vector<Helpers::TopicRouter<EventID>::BufferPtr_t> matched;
+    uint32_t start = micros();
+    for (size_t i = 0; i < NUM_ROUNDS; i++) {
+        std::string topic = "site/" + std::to_string(i % 10) + "/device/" +
+                            std::to_string(i) + "/temperature";
+        matched.clear();
+        router.match(topic, matched);
+    }
+    uint32_t elapsed = micros() - start;
+    Serial.printf("TopicRouter: %.3f us per topic (%u subscriptions)\n",
+                  float(elapsed) / NUM_ROUNDS, NUM_SUBSCRIPTIONS);
+
+    start = micros();
+    for (size_t i = 0; i < NUM_ROUNDS; i++) {
+        std::string topic = "site/" + std::to_string(i % 10) + "/device/" +
+                            std::to_string(i) + "/temperature";
+        matched.clear();
+        for (auto& strategy : strategies) {
+            if (topicMatches(strategy->filter, topic)) {
+                matched.push_back(strategy);
+            }
+        }
+    }
+    elapsed = micros() - start;
+    Serial.printf("Linear scan: %.3f us per topic (%u subscriptions)\n",
+                  float(elapsed) / NUM_ROUNDS, NUM_SUBSCRIPTIONS);
+}
+
+void setup() {
+    Serial.begin(115200);
+    delay(1000);
+
+    Helpers::TopicRouter<EventID> router;
+    auto thermostat = std::make_shared<Strategy>("sensors/+/temperature");
+    auto recorder = std::make_shared<Strategy>("sensors/#");
+    router.subscribe(thermostat->filter, thermostat);
+    router.subscribe(recorder->filter, recorder);
+
+    //* Routed by the "topic" field, into both strategies
+    JsonDocument message;
+    message["topic"] = "sensors/kitchen/temperature";
+    message["value"] = 21.5;
+    router.route(message);
+
+    //* Only the recorder is subscribed to humidity
+    router.route("sensors/kitchen/humidity", message);
+    Serial.printf("Thermostat: %u, Recorder: %u\n", thermostat->size(),
+                  recorder->size());
+
+    benchmark();
+}
+
+void loop() {}
@@ -32,6 +32,45 @@ class ConcreteElement : public Helpers::IElement {
     }
 };
 
+// Elements of a closed set dispatch at compile time through CRTP
+class Sensor : public Helpers::Element<Sensor> {
+   public:
+    float value = 21.5f;
+};
+
+class Actuator : public Helpers::Element<Actuator> {
+   public:
+    bool enabled = true;
+};
+
+using Component = Helpers::ElementVariant<Sensor, Actuator>;
+using Components = Helpers::ElementCollection<Sensor, Actuator>;
+
+void StaticClientCode(std::vector<Component>& components) {
+    // No virtual call or dynamic_cast per element, std::visit jumps straight
+    // to the matching lambda
+    Helpers::visitEach(components, Helpers::Overloaded{
+                                       [](Sensor& sensor) {
+                                           std::cout << "Sensor: "
+                                                     << sensor.value << "\n";
+                                       },
+                                       [](Actuator& actuator) {
+                                           std::cout << "Actuator: "
+                                                     << actuator.enabled
+                                                     << "\n";
+                                       },
+                                   });
+}
+
+void SegmentedClientCode(Components& components) {
+    // Each element type is stored contiguously and visited as a whole
+    // segment, so the loop body is inlined for a single type at a time
+    components.forEach(Helpers::Overloaded{
+        [](Sensor& sensor) { sensor.value += 1.0f; },
+        [](Actuator& actuator) { actuator.enabled = !actuator.enabled; },
+    });
+}
+
 void ClientCode(std::array<Helpers::IElement*, 2> components,
                 Helpers::VisitorRoot* visitor) {
     // ...
@@ -63,6 +102,18 @@ void setup() {
         delete comp;
     }
     delete visitor;
+
+    std::cout << "Closed sets of elements can be visited without RTTI:\n";
+    std::vector<Component> staticComponents = {Sensor(), Actuator()};
+    StaticClientCode(staticComponents);
+
+    std::cout << "Or stored per type and visited segment by segment:\n";
+    Components segmented;
+    uint64_t sensorID = segmented.emplace<Sensor>().getID();
+    segmented.emplace<Actuator>();
+    SegmentedClientCode(segmented);
+    segmented.erase(sensorID);
+    std::cout << "Components left: " << segmented.size() << "\n";
 }
 
 void loop() {}
\ No newline at end of file
@@ -1,13 +1,33 @@
 #pragma once
 
+#include <helpers/broadcast_ring.hpp>
+#include <helpers/element_collection.hpp>
 #include <helpers/enum_inheritance.hpp>
+#include <helpers/enum_reflection.hpp>
+#include <helpers/event_recorder.hpp>
+#include <helpers/frame_parser.hpp>
 #include <helpers/helpers.hpp>
 #include <helpers/iter_queue.hpp>
+#include <helpers/json_query.hpp>
 #include <helpers/logger.hpp>
 #include <helpers/make_unique.hpp>
+#include <helpers/memory_accounting.hpp>
 #include <helpers/observer.hpp>
+#include <helpers/progress.hpp>
+#include <helpers/ring_log.hpp>
+#include <helpers/spsc_queue.hpp>
+#include <helpers/task_graph.hpp>
+#include <helpers/timer_wheel.hpp>
+#include <helpers/topic_router.hpp>
+#include <helpers/message_batcher.hpp>
 #include <helpers/message_buffer.hpp>
+#include <helpers/message_schema.hpp>
 #include <helpers/visitor.hpp>
 
+#include <events/batched_event.hpp>
 #include <events/event.hpp>
+#include <events/event_coroutine.hpp>
 #include <events/event_interface.hpp>
+#include <events/event_pipeline.hpp>
+#include <events/event_replay.hpp>
+#include <events/event_timer.hpp>
@@ -0,0 +1,75 @@
+#pragma once
+#include <helpers/message_batcher.hpp>
+#include "event_interface.hpp"
+
+namespace Helpers {
+
+/**
+ * @brief A strategy whose JSON messages are sent in batches
+ * @tparam EnumT The Enum Type for the Event
+ * @note `sendMessage(const JsonDocument&)` queues the message in a
+ * `MessageBatcher`, each flushed batch reaches `sendBinary` as one write,
+ * framed as configured. `sendBinary` is the transport and must be
+ * implemented. The batcher can
+ * also be pointed at another sink with `getBatcher().setSink(...)`.
+ * @note Expired batches are flushed by `pollOutbound`, which
+ * `CustomEventManager::handleStrategies` calls. Call `flush` before
+ * destroying the strategy, pending messages are not sent on destruction.
+ *
+ * @code
+ * ```
+ * class Uplink : public Helpers::BatchedEvent<EventID> {
+ *    public:
+ *     Uplink() : BatchedEvent({2048, 32, 50, Helpers::FRAMING_NDJSON}) {}
+ *     void sendBinary(const uint8_t* data, size_t length) override {
+ *         client.write(data, length);
+ *     }
+ * };
+ * ```
+ */
+template <typename EnumT>
+class BatchedEvent : public IEvent<EnumT>, private BatchSink {
+    MessageBatcher batcher;
+
+    bool write(const uint8_t* data, size_t length, size_t) override {
+        this->sendBinary(data, length);
+        return true;
+    }
+
+   public:
+    explicit BatchedEvent(BatchConfig config = BatchConfig())
+        : batcher(*this, config) {}
+
+    BatchedEvent(BatchConfig config, MessageBatcher::Clock_t clock)
+        : batcher(*this, config, std::move(clock)) {}
+
+    void sendMessage(const JsonDocument& message) override {
+        batcher.add(message);
+    }
+
+    /**
+     * @brief The transport, receives each flushed batch
+     * @note Required, the default of `IEvent` would drop every batch
+     */
+    void sendBinary(const uint8_t* data, size_t length) override = 0;
+
+    void pollOutbound() override {
+        batcher.poll();
+    }
+
+    /**
+     * @brief Send the pending messages now
+     */
+    bool flush() {
+        return batcher.flush();
+    }
+
+    MessageBatcher& getBatcher() {
+        return batcher;
+    }
+
+    BatchStats getBatchStats() {
+        return batcher.getStats();
+    }
+};
+}  // namespace Helpers
@@ -1,12 +1,46 @@
 #pragma once
 
+#include <algorithm>
+#include <chrono>
+#include <functional>
 #include <helpers/iter_queue.hpp>
 #include <helpers/logger.hpp>
 #include <helpers/observer.hpp>
+#include <helpers/task_graph.hpp>
+#include <map>
 #include <memory>
+#include <vector>
 #include "event_interface.hpp"
+#include "event_timer.hpp"
+
+/**
+ * @brief Strategies `CustomEventManager::begin` starts at once
+ * @note By default they start one at a time on the calling task, in
+ * dependency, then insertion, order. Override with a build flag, e.g.
+ * `-DEASYHELPERS_STARTUP_WORKERS=4`, or call `begin(size_t)`, to start
+ * independent ones concurrently. Declaring dependencies alone never does.
+ */
+#ifndef EASYHELPERS_STARTUP_WORKERS
+#    define EASYHELPERS_STARTUP_WORKERS 1
+#endif
 
 namespace Helpers {
+
+/**
+ * @brief How a strategy was started by `CustomEventManager::begin`
+ * @param startOffset Microseconds from the start of the manager's `begin` to
+ * the start of the strategy's
+ * @param micros The duration of the strategy's `begin`
+ * @param deferred The strategy is started on first use
+ */
+struct StrategyInit {
+    uint64_t id = 0;
+    uint64_t startOffset = 0;
+    uint64_t micros = 0;
+    bool deferred = false;
+    bool started = false;
+};
+
 /**
  * @brief Custom Event Manager
  * @tparam EnumT The Enum Type for the Event
@@ -21,11 +55,69 @@ class CustomEventManager
       public IObserver<EnumT> {
     using Strategy_t = std::shared_ptr<IEvent<EnumT> >;
     using StrategyQueue_t = iter_queue<Strategy_t>;
+    using Clock_t = std::chrono::steady_clock;
 
    protected:
     //* Queue for the strategies
     SemaphoreHandle_t mutex;
     StrategyQueue_t strategyQueue;
+    //* Delayed and periodic notifications, polled by handleStrategies()
+    EventTimer<EnumT> timers;
+    //* Polled by handleStrategies() after the timers, e.g. a
+    //* `CoroutineScheduler`, by ID
+    std::map<uint64_t, std::function<void()> > pollers;
+    uint64_t nextPollerID = 1;
+    //* Startup of each strategy, by ID
+    std::map<uint64_t, StrategyInit> inits;
+    //* Deferred strategies not started yet, lets handleStrategies skip the
+    //* lookup once there are none
+    size_t deferredCount = 0;
+    Clock_t::time_point beginTime;
+    uint64_t startupMicros = 0;
+
+    uint64_t microsSince(Clock_t::time_point start) const {
+        return std::chrono::duration_cast<std::chrono::microseconds>(
+                   Clock_t::now() - start)
+            .count();
+    }
+
+    //* May run on a startup worker, so it must not log
+    void startStrategy(IEvent<EnumT>& strategy, StrategyInit& init) {
+        init.startOffset = microsSince(beginTime);
+        Clock_t::time_point start = Clock_t::now();
+        {
+            EASYHELPERS_MEMORY_SCOPE_CACHED(strategy.strategyMemory, "Strategy",
+                                            &strategy);
+            strategy.begin();
+        }
+        init.micros = microsSince(start);
+        init.started = true;
+    }
+
+    /**
+     * @brief Start a deferred strategy, and the deferred strategies it
+     * depends on, with the mutex held
+     */
+    void startDeferred(IEvent<EnumT>& strategy) {
+        auto init = inits.find(strategy.getID());
+        if (init == inits.end() || !init->second.deferred ||
+            init->second.started) {
+            return;
+        }
+        // marked first, so a dependency cycle ends here
+        init->second.started = true;
+        deferredCount--;
+        for (uint64_t id : strategy.dependencies) {
+            for (auto& dependency : strategyQueue) {
+                if (dependency->getID() == id) {
+                    startDeferred(*dependency);
+                    break;
+                }
+            }
+        }
+        this->log(LogLevel_t::DEBUG, "Strategy ID: ", strategy.getID());
+        startStrategy(strategy, init->second);
+    }
 
    public:
     CustomEventManager(const std::string& label) {
@@ -33,6 +125,18 @@ class CustomEventManager
         this->setLabel(label);
     }
 
+    /**
+     * @brief Construct a manager whose timers run on `clock`
+     * @param clock Returns the current time in milliseconds, e.g. a
+     * `VirtualClock` when replaying a recording
+     */
+    CustomEventManager(const std::string& label,
+                       typename EventTimer<EnumT>::Clock_t clock)
+        : timers(1, clock) {
+        mutex = xSemaphoreCreateMutex();
+        this->setLabel(label);
+    }
+
     virtual ~CustomEventManager() {
         this->stop();
         vSemaphoreDelete(mutex);
@@ -40,25 +144,171 @@ class CustomEventManager
 
     /**
      * @brief Initialize all strategies
-     * @note This will call the begin method for all strategies
+     * @note This will call the begin method for all strategies, one at a time
+     * in dependency, then insertion, order, unless
+     * `EASYHELPERS_STARTUP_WORKERS` is raised. See `begin(size_t)` to start
+     * them concurrently.
      */
     virtual void begin() {
+        begin(EASYHELPERS_STARTUP_WORKERS);
+    }
+
+    /**
+     * @brief Initialize all strategies, independent ones concurrently
+     * @param workers The maximum number of strategies starting at once, 1
+     * starts them on the calling task in dependency, then insertion, order.
+     * Further workers are `std::thread`s, FreeRTOS tasks on the ESP32 whose
+     * stack size is set with `esp_pthread_set_cfg`, and strategies started
+     * concurrently must not share unsynchronized resources such as Serial.
+     * @note A strategy's `begin` runs once the strategies it `dependsOn` have
+     * started. Strategies in a dependency cycle are not started.
+     * @note `deferrable` strategies are started by the first
+     * `handleStrategies` or `handleStrategy` reaching them, or by
+     * `ensureStarted`.
+     * @note The mutex is held throughout, strategies must not use the
+     * manager from their `begin`
+     */
+    void begin(size_t workers) {
         xSemaphoreTake(mutex, portMAX_DELAY);
         this->log("Initializing Strategies");
 
         // check if the queue is empty
         if (strategyQueue.empty()) {
             this->log(LogLevel_t::ERROR, "No strategies found");
+            xSemaphoreGive(mutex);
             return;
         }
 
-        for (auto& strategy : strategyQueue) {
-            this->log(LogLevel_t::DEBUG, "Strategy ID: ", strategy->getID());
-            strategy->begin();
+        std::vector<Strategy_t> strategies(strategyQueue.begin(),
+                                           strategyQueue.end());
+        std::map<uint64_t, size_t> index;
+        for (size_t i = 0; i < strategies.size(); i++) {
+            index[strategies[i]->getID()] = i;
+        }
+
+        // a deferrable strategy is still started now if a started one
+        // depends on it
+        std::vector<bool> needed(strategies.size(), false);
+        std::vector<size_t> pending;
+        for (size_t i = 0; i < strategies.size(); i++) {
+            if (!strategies[i]->deferrable) {
+                pending.push_back(i);
+            }
+        }
+        while (!pending.empty()) {
+            size_t i = pending.back();
+            pending.pop_back();
+            if (needed[i]) {
+                continue;
+            }
+            needed[i] = true;
+            for (uint64_t id : strategies[i]->dependencies) {
+                auto dependency = index.find(id);
+                if (dependency != index.end()) {
+                    pending.push_back(dependency->second);
+                }
+            }
+        }
+
+        std::vector<size_t> tasks;
+        std::vector<size_t> task(strategies.size());
+        for (size_t i = 0; i < strategies.size(); i++) {
+            if (needed[i]) {
+                task[i] = tasks.size();
+                tasks.push_back(i);
+            }
+        }
+        TaskGraph graph(tasks.size());
+        for (size_t t = 0; t < tasks.size(); t++) {
+            for (uint64_t id : strategies[tasks[t]]->dependencies) {
+                auto dependency = index.find(id);
+                if (dependency == index.end()) {
+                    this->log(LogLevel_t::WARN, "Strategy ",
+                              strategies[tasks[t]]->getID(),
+                              " depends on unknown strategy ", id);
+                    continue;
+                }
+                graph.addDependency(t, task[dependency->second]);
+            }
+        }
+
+        std::vector<StrategyInit> started(strategies.size());
+        for (size_t i = 0; i < strategies.size(); i++) {
+            started[i].id = strategies[i]->getID();
+            started[i].deferred = !needed[i];
+        }
+        beginTime = Clock_t::now();
+        std::vector<size_t> blocked = graph.run(
+            [&](size_t t) {
+                startStrategy(*strategies[tasks[t]], started[tasks[t]]);
+            },
+            workers);
+        startupMicros = microsSince(beginTime);
+
+        // logged once the workers are done, in the order they started
+        std::vector<const StrategyInit*> order;
+        for (auto& init : started) {
+            if (init.started) {
+                order.push_back(&init);
+            }
+        }
+        std::sort(order.begin(), order.end(),
+                  [](const StrategyInit* a, const StrategyInit* b) {
+                      return a->startOffset < b->startOffset;
+                  });
+        for (const StrategyInit* init : order) {
+            this->log(LogLevel_t::DEBUG, "Strategy ID: ", init->id);
+        }
+        for (size_t t : blocked) {
+            this->log(LogLevel_t::ERROR, "Dependency cycle, strategy ",
+                      strategies[tasks[t]]->getID(), " not started");
+        }
+
+        inits.clear();
+        deferredCount = 0;
+        for (auto& init : started) {
+            deferredCount += init.deferred;
+            inits[init.id] = init;
         }
         xSemaphoreGive(mutex);
     }
 
+    /**
+     * @brief Start a deferred strategy now, rather than on first use
+     */
+    void ensureStarted(Strategy_t strategy) {
+        xSemaphoreTake(mutex, portMAX_DELAY);
+        startDeferred(*strategy);
+        xSemaphoreGive(mutex);
+    }
+
+    /**
+     * @brief The startup of every strategy, in the order they were started
+     * @note Deferred strategies not used yet have `started` false
+     */
+    std::vector<StrategyInit> getInitStats() {
+        xSemaphoreTake(mutex, portMAX_DELAY);
+        std::vector<StrategyInit> stats;
+        for (auto& init : inits) {
+            stats.push_back(init.second);
+        }
+        xSemaphoreGive(mutex);
+        std::sort(stats.begin(), stats.end(),
+                  [](const StrategyInit& a, const StrategyInit& b) {
+                      return a.started > b.started ||
+                             (a.started == b.started &&
+                              a.startOffset < b.startOffset);
+                  });
+        return stats;
+    }
+
+    /**
+     * @brief Microseconds the last `begin` took, deferred strategies aside
+     */
+    uint64_t getStartupMicros() {
+        return startupMicros;
+    }
+
     /**
      * @brief Stop all strategies
      * @note This will remove all strategies from the queue and set the queue to
@@ -70,6 +320,8 @@ class CustomEventManager
             strategyQueue.pop();
         }
         strategyQueue = StrategyQueue_t();
+        inits.clear();
+        deferredCount = 0;
         this->log("Strategies Stopped");
         xSemaphoreGive(mutex);
     }
@@ -91,6 +343,7 @@ class CustomEventManager
         // Use the revised attach method
         strategy->attach(selfWeakPtr);
 
+        EASYHELPERS_MEMORY_SCOPE("CustomEventManager", this->getLabel());
         xSemaphoreTake(mutex, portMAX_DELAY);
         this->strategyQueue.emplace(strategy);
         xSemaphoreGive(mutex);
@@ -102,11 +355,17 @@ class CustomEventManager
      * @note This will remove the strategy from the queue
      */
     virtual void removeSubscriber(Strategy_t strategy) {
-        xSemaphoreTake(mutex, portMAX_DELAY);
-
         if (!strategy)
             return;  // Safety check
 
+        xSemaphoreTake(mutex, portMAX_DELAY);
+
+        auto init = inits.find(strategy->getID());
+        if (init != inits.end()) {
+            deferredCount -= init->second.deferred && !init->second.started;
+            inits.erase(init);
+        }
+
         StrategyQueue_t tempQueue;
         while (!strategyQueue.empty()) {
             auto strategyFront = strategyQueue.front();
@@ -124,20 +383,85 @@ class CustomEventManager
         xSemaphoreGive(mutex);
     }
 
+    /**
+     * @brief Get the timer service used to delay or repeat notifications
+     * @note Timers are delivered from `handleStrategies()`
+     */
+    EventTimer<EnumT>& getTimers() {
+        return timers;
+    }
+
+    /**
+     * @brief Call `poller` from every `handleStrategies()`, after the timers
+     * and outside of the manager mutex
+     * @note Add and remove pollers from the thread running
+     * `handleStrategies()`
+     * @return uint64_t The ID to pass to `removePoller`
+     */
+    uint64_t addPoller(std::function<void()> poller) {
+        uint64_t id = nextPollerID++;
+        pollers.emplace(id, std::move(poller));
+        return id;
+    }
+
+    /**
+     * @brief Stop calling a poller added with `addPoller`
+     */
+    void removePoller(uint64_t id) {
+        pollers.erase(id);
+    }
+
+    /**
+     * @brief Find a strategy by its ID
+     * @return Strategy_t The strategy, or `nullptr` if none has this ID
+     */
+    Strategy_t getStrategy(uint64_t id) {
+        Strategy_t found;
+        xSemaphoreTake(mutex, portMAX_DELAY);
+        for (auto& strategy : strategyQueue) {
+            if (strategy->getID() == id) {
+                found = strategy;
+                break;
+            }
+        }
+        xSemaphoreGive(mutex);
+        return found;
+    }
+
     /**
      * @brief Call in a loop to handle all strategies sequentially
-     * @note Here we call all Strategies for the API
+     * @note Here we call all Strategies for the API, then let them flush
+     * their outbound batches, see `BatchedEvent`
+     * @note Due timers are delivered first, then the pollers run, both
+     * outside of the manager mutex so that they may use the manager
      */
     virtual void handleStrategies() {
+        timers.poll();
+        // by ID, a poller may add or remove pollers, itself included
+        uint64_t polled = 0;
+        for (auto it = pollers.begin(); it != pollers.end();
+             it = pollers.upper_bound(polled)) {
+            polled = it->first;
+            std::function<void()> poller = it->second;
+            poller();
+        }
+
         xSemaphoreTake(mutex, portMAX_DELAY);
 
         if (strategyQueue.empty()) {
             this->log(LogLevel_t::ERROR, "No strategies found");
+            xSemaphoreGive(mutex);
             return;
         }
 
         for (auto& event : strategyQueue) {
+            if (deferredCount) {
+                startDeferred(*event);
+            }
+            EASYHELPERS_MEMORY_SCOPE_CACHED(event->strategyMemory, "Strategy",
+                                            event.get());
             event->receiveMessage();
+            event->pollOutbound();
         }
 
         xSemaphoreGive(mutex);
@@ -153,12 +477,18 @@ class CustomEventManager
 
         if (strategyQueue.empty()) {
             this->log(LogLevel_t::ERROR, "No strategies found");
+            xSemaphoreGive(mutex);
             return;
         }
 
         auto _strategy = strategyQueue.find(strategy);
         if (_strategy != strategyQueue.cend()) {
+            if (deferredCount) {
+                startDeferred(*strategy);
+            }
             strategy->receiveMessage();
+            strategy->pollOutbound();
+            xSemaphoreGive(mutex);
             return;
         }
 
@@ -0,0 +1,508 @@
+#pragma once
+
+/**
+ * @brief Coroutine based strategies
+ * @note Requires C++20 coroutines, e.g. `build_flags = -std=gnu++2a` with
+ * `build_unflags = -std=gnu++17` on a GCC 10+ toolchain. With older standards
+ * this header is empty.
+ */
+#if defined(__cpp_impl_coroutine) && __has_include(<coroutine>)
+
+#    include <atomic>
+#    include <chrono>
+#    include <coroutine>
+#    include <cstddef>
+#    include <cstdint>
+#    include <exception>
+#    include <functional>
+#    include <new>
+#    include <optional>
+#    include <unordered_map>
+#    include <unordered_set>
+#    include <utility>
+#    include <vector>
+#    include <events/event.hpp>
+#    include <helpers/message_buffer.hpp>
+#    include <helpers/observer.hpp>
+#    include <helpers/timer_wheel.hpp>
+
+/**
+ * @brief Size of the pooled coroutine frame blocks
+ * @note Larger frames fall back to the heap, override with a build flag if
+ * your strategies keep more state across suspension points
+ */
+#    ifndef EASYHELPERS_COROUTINE_FRAME_SIZE
+#        define EASYHELPERS_COROUTINE_FRAME_SIZE 256
+#    endif
+
+namespace Helpers {
+
+/**
+ * @brief Free list of fixed size blocks backing coroutine frames
+ * @note Blocks are recycled instead of returned to the heap, so a steady
+ * population of coroutines stops allocating after warm up
+ */
+class CoroutineFramePool {
+    struct Block {
+        Block* next;
+    };
+
+    inline static Block* freeBlocks = nullptr;
+    inline static std::atomic_flag lock = ATOMIC_FLAG_INIT;
+
+    static void acquire() {
+        while (lock.test_and_set(std::memory_order_acquire)) {
+        }
+    }
+
+    static void releaseLock() {
+        lock.clear(std::memory_order_release);
+    }
+
+   public:
+    static constexpr size_t BLOCK_SIZE = EASYHELPERS_COROUTINE_FRAME_SIZE;
+
+    static void* allocate(size_t size) {
+        if (size > BLOCK_SIZE) {
+            return ::operator new(size);
+        }
+        acquire();
+        Block* block = freeBlocks;
+        if (block) {
+            freeBlocks = block->next;
+        }
+        releaseLock();
+        return block ? static_cast<void*>(block) : ::operator new(BLOCK_SIZE);
+    }
+
+    static void deallocate(void* pointer, size_t size) {
+        if (size > BLOCK_SIZE) {
+            ::operator delete(pointer);
+            return;
+        }
+        Block* block = static_cast<Block*>(pointer);
+        acquire();
+        block->next = freeBlocks;
+        freeBlocks = block;
+        releaseLock();
+    }
+};
+
+template <typename EnumT>
+class CoroutineScheduler;
+
+/**
+ * @brief Return type of a coroutine strategy
+ * @tparam EnumT The Enum Type for the Event
+ * @note The coroutine starts suspended and only runs once handed to
+ * `CoroutineScheduler::spawn`
+ */
+template <typename EnumT>
+class StrategyTask {
+   public:
+    struct promise_type {
+        CoroutineScheduler<EnumT>* scheduler = nullptr;
+
+        //* What the coroutine is suspended on
+        MessageBuffer<EnumT>* waitBuffer = nullptr;
+        std::optional<EnumT> waitEvent;
+        uint64_t timer = 0;
+        bool timedOut = false;
+
+        StrategyTask get_return_object() {
+            return StrategyTask(
+                std::coroutine_handle<promise_type>::from_promise(*this));
+        }
+        std::suspend_always initial_suspend() noexcept {
+            return {};
+        }
+        std::suspend_always final_suspend() noexcept {
+            return {};
+        }
+        void return_void() {}
+        void unhandled_exception() {
+            std::terminate();
+        }
+
+        static void* operator new(size_t size) {
+            return CoroutineFramePool::allocate(size);
+        }
+        static void operator delete(void* pointer, size_t size) {
+            CoroutineFramePool::deallocate(pointer, size);
+        }
+    };
+    using Handle_t = std::coroutine_handle<promise_type>;
+
+    StrategyTask(StrategyTask&& other) noexcept
+        : handle(std::exchange(other.handle, {})) {}
+    StrategyTask(const StrategyTask&) = delete;
+    StrategyTask& operator=(const StrategyTask&) = delete;
+
+    ~StrategyTask() {
+        if (handle) {
+            handle.destroy();
+        }
+    }
+
+    Handle_t release() {
+        return std::exchange(handle, {});
+    }
+
+   private:
+    explicit StrategyTask(Handle_t handle) : handle(handle) {}
+    Handle_t handle;
+};
+
+/**
+ * @brief Runs coroutine strategies on a single thread
+ * @tparam EnumT The Enum Type for the Event
+ * @note A suspended coroutine costs nothing per `poll`: it is resumed only
+ * when the message, event or timeout it awaits fires.
+ * @note Only `dispatch` is thread-safe. `MessageBuffer` has no lock, so the
+ * buffers awaited with `nextMessage` must be filled on the thread calling
+ * `poll`, e.g. from the strategies' `receiveMessage`.
+ * @note `attach` lets a `CustomEventManager` poll the scheduler from
+ * `handleStrategies()`, right after its timers.
+ *
+ * @code
+ * ```
+ * Helpers::StrategyTask<EventID> blink(
+ *     Helpers::CoroutineScheduler<EventID>& scheduler,
+ *     Helpers::MessageBuffer<EventID>& inbox) {
+ *     while (true) {
+ *         auto message = co_await scheduler.nextMessage(inbox, 1000);
+ *         if (!message) {
+ *             continue;  // nothing received within a second
+ *         }
+ *         co_await scheduler.waitFor(EventID::EVENT_1);
+ *         co_await scheduler.sleep(100);
+ *     }
+ * }
+ *
+ * scheduler.spawn(blink(scheduler, *strategy));
+ * scheduler.attach(*manager);
+ * // in the manager's update(): scheduler.dispatch(event);
+ * ```
+ */
+template <typename EnumT>
+class CoroutineScheduler {
+   public:
+    using Task_t = StrategyTask<EnumT>;
+    using Handle_t = typename Task_t::Handle_t;
+    using Clock_t = std::function<uint64_t()>;
+
+   private:
+    struct MessageWatch {
+        Subscription<EnumT> subscription;
+        std::atomic<bool> signalled{false};
+        std::vector<Handle_t> waiters;
+    };
+
+    SemaphoreHandle_t mutex;
+    std::vector<EnumT> pendingEvents;
+    std::vector<EnumT> processingEvents;
+    std::atomic<bool> messagesSignalled{false};
+
+    std::unordered_map<MessageBuffer<EnumT>*, MessageWatch> watches;
+    std::unordered_map<long long, std::vector<Handle_t> > eventWaiters;
+    std::vector<Handle_t> ready;
+    std::unordered_set<void*> tasks;
+
+    CustomEventManager<EnumT>* manager = nullptr;
+    uint64_t pollerID = 0;
+
+    Clock_t clock;
+    TimerWheel<Handle_t> timers;
+
+    static uint64_t steadyMillis() {
+        return std::chrono::duration_cast<std::chrono::milliseconds>(
+                   std::chrono::steady_clock::now().time_since_epoch())
+            .count();
+    }
+
+    static void removeWaiter(std::vector<Handle_t>& waiters, Handle_t handle) {
+        for (auto it = waiters.begin(); it != waiters.end(); ++it) {
+            if (*it == handle) {
+                waiters.erase(it);
+                return;
+            }
+        }
+    }
+
+    void armTimeout(Handle_t handle, uint32_t timeoutMs) {
+        auto& promise = handle.promise();
+        promise.timedOut = false;
+        if (timeoutMs > 0) {
+            promise.timer = timers.schedule(clock() + timeoutMs, 0, handle);
+        }
+    }
+
+    // the awaited condition fired, drop the timeout and queue the coroutine
+    void wake(Handle_t handle) {
+        auto& promise = handle.promise();
+        if (promise.timer != TimerWheel<Handle_t>::INVALID_TIMER) {
+            timers.cancel(promise.timer);
+            promise.timer = TimerWheel<Handle_t>::INVALID_TIMER;
+        }
+        promise.waitBuffer = nullptr;
+        promise.waitEvent.reset();
+        ready.push_back(handle);
+    }
+
+    // the timeout fired first, stop waiting for the condition
+    void expire(Handle_t handle) {
+        auto& promise = handle.promise();
+        promise.timer = TimerWheel<Handle_t>::INVALID_TIMER;
+        promise.timedOut = true;
+        if (promise.waitBuffer) {
+            removeWaiter(watches[promise.waitBuffer].waiters, handle);
+            promise.waitBuffer = nullptr;
+        }
+        if (promise.waitEvent) {
+            auto key = static_cast<long long>(*promise.waitEvent);
+            removeWaiter(eventWaiters[key], handle);
+            promise.waitEvent.reset();
+        }
+        ready.push_back(handle);
+    }
+
+    void resume(Handle_t handle) {
+        handle.resume();
+        if (handle.done()) {
+            tasks.erase(handle.address());
+            handle.destroy();
+        }
+    }
+
+    void waitMessage(Handle_t handle, MessageBuffer<EnumT>& buffer,
+                     uint32_t timeoutMs) {
+        auto& watch = watches[&buffer];
+        if (!watch.subscription) {
+            watch.subscription =
+                buffer.subscribe([this, &watch](const EnumT&) {
+                    watch.signalled.store(true, std::memory_order_relaxed);
+                    messagesSignalled.store(true, std::memory_order_release);
+                });
+        }
+        handle.promise().waitBuffer = &buffer;
+        watch.waiters.push_back(handle);
+        armTimeout(handle, timeoutMs);
+    }
+
+    void waitEvent(Handle_t handle, EnumT event, uint32_t timeoutMs) {
+        handle.promise().waitEvent = event;
+        eventWaiters[static_cast<long long>(event)].push_back(handle);
+        armTimeout(handle, timeoutMs);
+    }
+
+   public:
+    struct MessageAwaiter {
+        CoroutineScheduler* scheduler;
+        MessageBuffer<EnumT>* buffer;
+        uint32_t timeoutMs;
+
+        bool await_ready() {
+            return !buffer->isEmpty();
+        }
+        void await_suspend(Handle_t handle) {
+            scheduler->waitMessage(handle, *buffer, timeoutMs);
+        }
+        std::optional<JsonDocument> await_resume() {
+            return buffer->getMessage();
+        }
+    };
+
+    struct EventAwaiter {
+        CoroutineScheduler* scheduler;
+        EnumT event;
+        uint32_t timeoutMs;
+        Handle_t handle;
+
+        bool await_ready() {
+            return false;
+        }
+        void await_suspend(Handle_t suspended) {
+            handle = suspended;
+            scheduler->waitEvent(handle, event, timeoutMs);
+        }
+        bool await_resume() {
+            return !handle.promise().timedOut;
+        }
+    };
+
+    struct SleepAwaiter {
+        CoroutineScheduler* scheduler;
+        uint32_t durationMs;
+
+        bool await_ready() {
+            return durationMs == 0;
+        }
+        void await_suspend(Handle_t handle) {
+            scheduler->armTimeout(handle, durationMs);
+        }
+        void await_resume() {}
+    };
+
+    /**
+     * @brief Construct a new Coroutine Scheduler
+     * @param clock Returns the current time in milliseconds
+     */
+    explicit CoroutineScheduler(Clock_t clock = steadyMillis)
+        : mutex(xSemaphoreCreateMutex()),
+          clock(clock),
+          timers(this->clock()) {}
+
+    virtual ~CoroutineScheduler() {
+        detach();
+        for (void* address : tasks) {
+            Handle_t::from_address(address).destroy();
+        }
+        vSemaphoreDelete(mutex);
+    }
+
+    CoroutineScheduler(const CoroutineScheduler&) = delete;
+    CoroutineScheduler& operator=(const CoroutineScheduler&) = delete;
+
+    /**
+     * @brief Hand a coroutine over to the scheduler
+     * @note It starts running on the next `poll`
+     */
+    void spawn(Task_t task) {
+        Handle_t handle = task.release();
+        if (!handle) {
+            return;
+        }
+        handle.promise().scheduler = this;
+        tasks.insert(handle.address());
+        ready.push_back(handle);
+    }
+
+    /**
+     * @brief Let `manager` poll the scheduler from `handleStrategies()`
+     * @note Call from the thread running `handleStrategies()`. The manager
+     * must outlive the scheduler, which detaches itself when destroyed.
+     */
+    void attach(CustomEventManager<EnumT>& target) {
+        detach();
+        manager = &target;
+        pollerID = target.addPoller([this]() { poll(); });
+    }
+
+    /**
+     * @brief Stop the attached manager from polling the scheduler
+     */
+    void detach() {
+        if (manager) {
+            manager->removePoller(pollerID);
+            manager = nullptr;
+        }
+    }
+
+    /**
+     * @brief `co_await` the next message of a buffer
+     * @param buffer The buffer to read from, usually the strategy itself
+     * @param timeoutMs Give up after this long, 0 waits forever
+     * @return std::optional<JsonDocument> The message, empty on timeout or
+     * if another consumer of the buffer took it first
+     */
+    MessageAwaiter nextMessage(MessageBuffer<EnumT>& buffer,
+                               uint32_t timeoutMs = 0) {
+        return {this, &buffer, timeoutMs};
+    }
+
+    /**
+     * @brief `co_await` an event passed to `dispatch`
+     * @param timeoutMs Give up after this long, 0 waits forever
+     * @return bool false if the timeout fired first
+     */
+    EventAwaiter waitFor(EnumT event, uint32_t timeoutMs = 0) {
+        return {this, event, timeoutMs, {}};
+    }
+
+    /**
+     * @brief `co_await` a delay
+     */
+    SleepAwaiter sleep(uint32_t durationMs) {
+        return {this, durationMs};
+    }
+
+    /**
+     * @brief Wake the coroutines waiting for `event`
+     * @note Safe to call from `update` or another thread, the coroutines are
+     * resumed by the next `poll`
+     */
+    void dispatch(EnumT event) {
+        xSemaphoreTake(mutex, portMAX_DELAY);
+        pendingEvents.push_back(event);
+        xSemaphoreGive(mutex);
+    }
+
+    /**
+     * @brief Resume every coroutine whose awaited condition fired
+     * @return size_t The number of resumptions
+     */
+    size_t poll() {
+        xSemaphoreTake(mutex, portMAX_DELAY);
+        std::swap(pendingEvents, processingEvents);
+        xSemaphoreGive(mutex);
+
+        for (const EnumT& event : processingEvents) {
+            auto bucket = eventWaiters.find(static_cast<long long>(event));
+            if (bucket == eventWaiters.end()) {
+                continue;
+            }
+            std::vector<Handle_t> waiters;
+            std::swap(waiters, bucket->second);
+            for (Handle_t handle : waiters) {
+                wake(handle);
+            }
+        }
+        processingEvents.clear();
+
+        if (messagesSignalled.exchange(false, std::memory_order_acquire)) {
+            for (auto& [buffer, watch] : watches) {
+                if (!watch.signalled.exchange(false,
+                                              std::memory_order_relaxed)) {
+                    continue;
+                }
+                // one waiter per buffered message, each consumes its own.
+                // The buffer is filled on this thread, so the count holds
+                size_t available = buffer->size();
+                while (available > 0 && !watch.waiters.empty()) {
+                    Handle_t handle = watch.waiters.front();
+                    watch.waiters.erase(watch.waiters.begin());
+                    wake(handle);
+                    available--;
+                }
+            }
+        }
+
+        timers.collect(clock());
+        Handle_t expired;
+        while (timers.popExpired(expired)) {
+            expire(expired);
+        }
+
+        size_t resumed = 0;
+        std::vector<Handle_t> batch;
+        while (!ready.empty()) {
+            std::swap(batch, ready);
+            for (Handle_t handle : batch) {
+                resume(handle);
+                resumed++;
+            }
+            batch.clear();
+        }
+        return resumed;
+    }
+
+    /**
+     * @brief The number of live coroutines
+     */
+    size_t size() const {
+        return tasks.size();
+    }
+};
+}  // namespace Helpers
+
+#endif
@@ -2,6 +2,9 @@
 #include <ArduinoJson.h>
 #include <helpers/id_interface.hpp>
 #include <helpers/message_buffer.hpp>
+#include <helpers/message_schema.hpp>
+#include <type_traits>
+#include <vector>
 
 namespace Helpers {
 template <typename EnumT>
@@ -9,7 +12,47 @@ class IEvent : public IId, public MessageBuffer<EnumT> {
    public:
     virtual void begin() {}
     virtual void sendMessage(const JsonDocument& message) {}
+
+    /**
+     * @brief Send a binary payload, e.g. a schema encoded message
+     */
+    virtual void sendBinary(const uint8_t*, size_t) {}
+
+    /**
+     * @brief Encode a schema struct and send it with `sendBinary`
+     * @tparam T The message struct, see `EASYHELPERS_MESSAGE_SCHEMA`
+     */
+    template <typename T, typename = typename std::enable_if<
+                              MessageSchema<T>::defined>::type>
+    void sendEncoded(const T& message) {
+        std::vector<uint8_t> encoded;
+        encodeMessage(message, encoded);
+        sendBinary(encoded.data(), encoded.size());
+    }
     virtual void receiveMessage() {}
+
+    /**
+     * @brief Called by `CustomEventManager::handleStrategies` after
+     * `receiveMessage`, for outbound work that is due on time rather than on
+     * a message, e.g. a batch whose linger has expired
+     */
+    virtual void pollOutbound() {}
+
+    /**
+     * @brief Have `CustomEventManager::begin` complete the other strategy's
+     * `begin` before this one's
+     */
+    void dependsOn(const IId& strategy) {
+        dependencies.push_back(strategy.getID());
+    }
+
     bool repeat = false;
+    //* IDs of the strategies this one depends on, see `dependsOn`
+    std::vector<uint64_t> dependencies;
+    //* Run `begin` on first use rather than at startup, unless a strategy
+    //* that is started depends on this one
+    bool deferrable = false;
+    //* The "Strategy" account charged while the manager runs this strategy
+    EASYHELPERS_MEMORY_ACCOUNT_CACHE(strategyMemory);
 };
 }  // namespace Helpers
\ No newline at end of file
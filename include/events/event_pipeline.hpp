@@ -0,0 +1,488 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <helpers/memory_accounting.hpp>
+#include <helpers/spsc_queue.hpp>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+#include "event_interface.hpp"
+
+namespace Helpers {
+
+/**
+ * @brief A strategy written for a pipeline, handed one message at a time
+ * @tparam EnumT The Enum Type for the Event
+ */
+template <typename EnumT>
+class PipelineStage : public IEvent<EnumT> {
+    template <typename>
+    friend class EventPipeline;
+
+    std::function<void(JsonDocument&&)> output;
+
+   public:
+    /**
+     * @brief Handle one message, `emit` the results for the next stage
+     * @note Emitting nothing drops the message, emitting several fans it out
+     */
+    virtual void process(JsonDocument& message) = 0;
+
+   protected:
+    /**
+     * @brief Pass a message to the next stage
+     * @note Blocks while the next stage's queue is full
+     */
+    void emit(JsonDocument&& message) {
+        if (output) {
+            output(std::move(message));
+        }
+    }
+
+    void emit(const JsonDocument& message) {
+        emit(JsonDocument(message));
+    }
+};
+
+/**
+ * @brief Counters of one pipeline stage
+ * @param id The strategy's ID
+ * @param processed The messages taken from the stage's queue
+ * @param emitted The messages passed on to the next stage or the output
+ * @param stalls The times the stage waited for room downstream
+ * @param dropped The messages lost because the pipeline stopped without
+ * draining
+ * @param queueDepth The messages waiting in the stage's queue
+ * @param peakDepth The most messages that waited in the queue
+ * @param capacity The size of the queue
+ * @param messagesPerSecond The stage's throughput since the pipeline started
+ * @param utilization The fraction of that time spent processing, waiting
+ * for room downstream excluded
+ * @note The counters are word sized, so they stay lock free on 32 bit
+ * targets, where they wrap around at 2^32.
+ */
+struct StageStats {
+    uint64_t id;
+    size_t processed;
+    size_t emitted;
+    size_t stalls;
+    size_t dropped;
+    size_t queueDepth;
+    size_t peakDepth;
+    size_t capacity;
+    double messagesPerSecond;
+    double utilization;
+};
+
+/**
+ * @brief Strategies chained as stages, e.g. parse, filter, enrich, send,
+ * linked by bounded lock free queues
+ * @tparam EnumT The Enum Type for the Event
+ * @note After `start()` every stage runs on its own thread, a FreeRTOS task
+ * on the ESP32, so the stages overlap in time. Size their stacks with
+ * `esp_pthread_set_cfg` before starting. Without `start()`, `pump()` runs the
+ * stages on the calling thread, e.g. from `loop()`.
+ * @note Backpressure: a stage whose downstream queue is full waits for room,
+ * so a slow stage throttles everything up to `push`, and `tryPush` fails.
+ * @note `PipelineStage`s get each message through `process` and `emit` their
+ * results. Any other strategy gets it through `addMessage` and
+ * `receiveMessage()`, and the messages left in its buffer afterwards are
+ * passed on.
+ * @note Messages leaving the last stage go to the `onOutput` handler, if any.
+ *
+ * @code
+ * ```
+ * Helpers::EventPipeline<EventID> pipeline(32);
+ * pipeline.addStage(parser);
+ * pipeline.addStage(filter);
+ * pipeline.addStage(sender);
+ * pipeline.start();
+ *
+ * pipeline.push(std::move(message));
+ * ```
+ */
+template <typename EnumT>
+class EventPipeline {
+   public:
+    using Strategy_t = std::shared_ptr<IEvent<EnumT> >;
+    using Output_t = std::function<void(JsonDocument&)>;
+
+   private:
+    using Clock_t = std::chrono::steady_clock;
+
+    //* Sleeps until notified, for the idle or blocked side of a queue
+    class Signal {
+        std::mutex mutex;
+        std::condition_variable condition;
+        std::atomic<uint32_t> waiters{0};
+
+       public:
+        template <typename Predicate>
+        void wait(Predicate ready) {
+            for (int spin = 0; spin < 64; spin++) {
+                if (ready()) {
+                    return;
+                }
+                std::this_thread::yield();
+            }
+            std::unique_lock<std::mutex> lock(mutex);
+            waiters.fetch_add(1);
+            // the timeout only bounds a lost wakeup, it is not the wakeup
+            condition.wait_for(lock, std::chrono::milliseconds(10), ready);
+            waiters.fetch_sub(1);
+        }
+
+        void notify() {
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            if (waiters.load()) {
+                std::lock_guard<std::mutex> lock(mutex);
+                condition.notify_all();
+            }
+        }
+    };
+
+    static_assert(std::atomic<size_t>::is_always_lock_free,
+                  "Stage counters must be lock free");
+
+    struct Stage {
+        Strategy_t strategy;
+        PipelineStage<EnumT>* pipelineStage;
+        SpscQueue<JsonDocument> input;
+        Signal notEmpty;
+        Signal notFull;
+        std::atomic<bool> busy{false};
+        std::atomic<size_t> processed{0};
+        std::atomic<size_t> emitted{0};
+        std::atomic<size_t> stalls{0};
+        std::atomic<size_t> dropped{0};
+        //* Only touched by the thread processing the stage, `busyMillis`
+        //* publishes the busy time to `stats`
+        uint64_t busyMicros = 0;
+        uint64_t stallMicros = 0;
+        std::atomic<size_t> busyMillis{0};
+        std::atomic<size_t> peakDepth{0};
+        std::thread thread;
+
+        Stage(Strategy_t strategy, size_t capacity)
+            : strategy(std::move(strategy)),
+              pipelineStage(
+                  dynamic_cast<PipelineStage<EnumT>*>(this->strategy.get())),
+              input(capacity) {}
+    };
+
+    size_t queueCapacity;
+    std::vector<std::unique_ptr<Stage> > stages;
+    Output_t output;
+    std::atomic<size_t> outputCount{0};
+    std::atomic<bool> running{false};
+    bool threaded = false;
+    //* Producers calling `push` share the first queue
+    std::mutex sourceMutex;
+    Clock_t::time_point startTime = Clock_t::now();
+
+    static uint64_t elapsedMicros(Clock_t::time_point since) {
+        return std::chrono::duration_cast<std::chrono::microseconds>(
+                   Clock_t::now() - since)
+            .count();
+    }
+
+    //* Queue a message for `stage`, the single producer of its queue
+    bool enqueue(Stage& stage, JsonDocument&& message) {
+        if (!stage.input.tryPush(std::move(message))) {
+            return false;
+        }
+        size_t depth = stage.input.size();
+        if (depth > stage.peakDepth.load(std::memory_order_relaxed)) {
+            stage.peakDepth.store(depth, std::memory_order_relaxed);
+        }
+        stage.notEmpty.notify();
+        return true;
+    }
+
+    //* Pass the output of stage `index` downstream, waiting for room
+    void deliver(size_t index, JsonDocument&& message) {
+        Stage& from = *stages[index];
+        from.emitted.fetch_add(1, std::memory_order_relaxed);
+        if (index + 1 == stages.size()) {
+            outputCount.fetch_add(1, std::memory_order_relaxed);
+            if (output) {
+                output(message);
+            }
+            return;
+        }
+
+        Stage& to = *stages[index + 1];
+        while (!enqueue(to, std::move(message))) {
+            if (threaded && !running.load()) {
+                // stopped without draining, the next stage has quit
+                from.dropped.fetch_add(1, std::memory_order_relaxed);
+                return;
+            }
+            from.stalls.fetch_add(1, std::memory_order_relaxed);
+            auto stalled = Clock_t::now();
+            if (threaded) {
+                to.notFull.wait([this, &to]() {
+                    return to.input.size() < to.input.capacity() ||
+                           !running.load();
+                });
+            } else {
+                // nobody else drains the queue, make room inline
+                processOne(index + 1);
+            }
+            from.stallMicros += elapsedMicros(stalled);
+        }
+    }
+
+    //* Process one message queued for stage `index`, false if none
+    bool processOne(size_t index) {
+        Stage& stage = *stages[index];
+        stage.busy.store(true);
+        JsonDocument message;
+        if (!stage.input.tryPop(message)) {
+            stage.busy.store(false);
+            return false;
+        }
+        stage.notFull.notify();
+
+        auto started = Clock_t::now();
+        uint64_t stalledBefore = stage.stallMicros;
+        {
+            EASYHELPERS_MEMORY_SCOPE_CACHED(stage.strategy->strategyMemory,
+                                            "Strategy", stage.strategy.get());
+            if (stage.pipelineStage) {
+                stage.pipelineStage->process(message);
+            } else {
+                stage.strategy->addMessage(message);
+                stage.strategy->receiveMessage();
+                while (auto left = stage.strategy->getMessage()) {
+                    deliver(index, std::move(*left));
+                }
+            }
+        }
+        // waiting for room downstream is not work
+        uint64_t stalled = stage.stallMicros - stalledBefore;
+        uint64_t elapsed = elapsedMicros(started);
+        stage.busyMicros += elapsed > stalled ? elapsed - stalled : 0;
+        stage.busyMillis.store(static_cast<size_t>(stage.busyMicros / 1000),
+                               std::memory_order_relaxed);
+        stage.processed.fetch_add(1, std::memory_order_relaxed);
+        stage.busy.store(false);
+        return true;
+    }
+
+    void run(size_t index) {
+        Stage& stage = *stages[index];
+        while (running.load()) {
+            if (!processOne(index)) {
+                stage.notEmpty.wait([this, &stage]() {
+                    return !stage.input.empty() || !running.load();
+                });
+            }
+        }
+    }
+
+    bool drained() const {
+        // upstream first, whatever a stage passes on is queued downstream
+        // before it goes idle
+        for (const auto& stage : stages) {
+            if (stage->busy.load() || !stage->input.empty()) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+   public:
+    /**
+     * @brief Construct a new Event Pipeline
+     * @param queueCapacity The default size of each stage's input queue
+     */
+    explicit EventPipeline(size_t queueCapacity = 16)
+        : queueCapacity(queueCapacity) {}
+
+    virtual ~EventPipeline() {
+        stop(false);
+    }
+
+    EventPipeline(const EventPipeline&) = delete;
+    EventPipeline& operator=(const EventPipeline&) = delete;
+
+    /**
+     * @brief Append a stage, before `start()`
+     * @param strategy The strategy handling the stage
+     * @param capacity The size of the stage's input queue, 0 for the default
+     * @return size_t The stage's index
+     */
+    size_t addStage(Strategy_t strategy, size_t capacity = 0) {
+        size_t index = stages.size();
+        stages.emplace_back(
+            new Stage(std::move(strategy), capacity ? capacity : queueCapacity));
+        if (stages.back()->pipelineStage) {
+            stages.back()->pipelineStage->output =
+                [this, index](JsonDocument&& message) {
+                    deliver(index, std::move(message));
+                };
+        }
+        return index;
+    }
+
+    /**
+     * @brief Handle the messages leaving the last stage
+     * @note Called from the last stage's thread
+     */
+    void onOutput(Output_t handler) {
+        output = std::move(handler);
+    }
+
+    /**
+     * @brief Feed a message to the first stage
+     * @return false if its queue is full
+     */
+    bool tryPush(JsonDocument message) {
+        if (stages.empty()) {
+            return false;
+        }
+        std::lock_guard<std::mutex> lock(sourceMutex);
+        return enqueue(*stages.front(), std::move(message));
+    }
+
+    /**
+     * @brief Feed a message to the first stage, waiting for room
+     * @note Without `start()`, a full queue is drained with `pump()`
+     */
+    void push(JsonDocument message) {
+        if (stages.empty()) {
+            return;
+        }
+        Stage& first = *stages.front();
+        std::unique_lock<std::mutex> lock(sourceMutex);
+        while (!enqueue(first, std::move(message))) {
+            lock.unlock();
+            if (threaded) {
+                first.notFull.wait([&first]() {
+                    return first.input.size() < first.input.capacity();
+                });
+            } else {
+                pump();
+            }
+            lock.lock();
+        }
+    }
+
+    /**
+     * @brief Run every stage on its own thread
+     */
+    void start() {
+        if (threaded || stages.empty()) {
+            return;
+        }
+        running.store(true);
+        threaded = true;
+        startTime = Clock_t::now();
+        for (size_t i = 0; i < stages.size(); i++) {
+            stages[i]->thread = std::thread(&EventPipeline::run, this, i);
+        }
+    }
+
+    /**
+     * @brief Stop the stage threads
+     * @param drain Wait for every queued message to leave the pipeline first.
+     * Otherwise each stage finishes its current message, what it passes on
+     * without room downstream is dropped and the rest stays queued.
+     */
+    void stop(bool drain = true) {
+        if (!threaded) {
+            return;
+        }
+        if (drain) {
+            flush();
+        }
+        running.store(false);
+        for (auto& stage : stages) {
+            stage->notEmpty.notify();
+            stage->notFull.notify();
+        }
+        for (auto& stage : stages) {
+            stage->thread.join();
+        }
+        threaded = false;
+    }
+
+    /**
+     * @brief Run the stages on the calling thread until the queues are empty
+     * @param maxMessages The most messages each stage takes from its queue
+     * @return size_t The number of messages processed by all stages
+     * @note Only without `start()`, from one thread at a time
+     */
+    size_t pump(size_t maxMessages = SIZE_MAX) {
+        if (threaded) {
+            return 0;
+        }
+        size_t total = 0;
+        for (size_t i = 0; i < stages.size(); i++) {
+            for (size_t count = 0; count < maxMessages && processOne(i);
+                 count++) {
+                total++;
+            }
+        }
+        return total;
+    }
+
+    /**
+     * @brief Wait until every queued message has left the pipeline
+     */
+    void flush() {
+        if (!threaded) {
+            while (pump() > 0) {
+            }
+            return;
+        }
+        while (!drained()) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+    }
+
+    bool isRunning() const {
+        return threaded;
+    }
+
+    size_t size() const {
+        return stages.size();
+    }
+
+    /**
+     * @brief The number of messages that left the last stage
+     */
+    size_t getOutputCount() const {
+        return outputCount.load(std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Counters of every stage, in pipeline order
+     */
+    std::vector<StageStats> stats() const {
+        std::vector<StageStats> result;
+        double seconds =
+            std::chrono::duration<double>(Clock_t::now() - startTime).count();
+        for (const auto& stage : stages) {
+            size_t processed = stage->processed.load();
+            double busySeconds = stage->busyMillis.load() / 1e3;
+            result.push_back({stage->strategy->getID(), processed,
+                              stage->emitted.load(), stage->stalls.load(),
+                              stage->dropped.load(),
+                              stage->input.size(), stage->peakDepth.load(),
+                              stage->input.capacity(),
+                              seconds > 0 ? processed / seconds : 0,
+                              seconds > 0 ? busySeconds / seconds : 0});
+        }
+        return result;
+    }
+};
+}  // namespace Helpers
@@ -0,0 +1,282 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <helpers/event_recorder.hpp>
+#include <helpers/frame_parser.hpp>
+#include <memory>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+#include "event.hpp"
+
+namespace Helpers {
+
+/**
+ * @brief A clock that only moves when told to, in microseconds
+ * @note Hand `millisClock()` to the `CustomEventManager` being replayed into,
+ * its timers then fire at the recorded times whatever the replay speed.
+ * @note The time is kept as two 32 bit halves behind a sequence counter, a
+ * 64 bit atomic would take a lock on the ESP32. Reads are lock free from any
+ * thread, `set` and `advance` must come from a single thread.
+ */
+class VirtualClock {
+    static_assert(std::atomic<uint32_t>::is_always_lock_free,
+                  "VirtualClock must be lock free");
+
+    //* Odd while the halves are being written
+    std::atomic<uint32_t> sequence{0};
+    std::atomic<uint32_t> highUs{0};
+    std::atomic<uint32_t> lowUs{0};
+
+   public:
+    void set(uint64_t us) {
+        uint32_t start = sequence.load(std::memory_order_relaxed);
+        sequence.store(start + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        highUs.store(static_cast<uint32_t>(us >> 32),
+                     std::memory_order_relaxed);
+        lowUs.store(static_cast<uint32_t>(us), std::memory_order_relaxed);
+        sequence.store(start + 2, std::memory_order_release);
+    }
+
+    void advance(uint64_t us) {
+        set(micros() + us);
+    }
+
+    uint64_t micros() const {
+        uint32_t before, after;
+        uint64_t us;
+        do {
+            before = sequence.load(std::memory_order_acquire);
+            us = (uint64_t(highUs.load(std::memory_order_relaxed)) << 32) |
+                 lowUs.load(std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_acquire);
+            after = sequence.load(std::memory_order_relaxed);
+        } while ((before & 1) || before != after);
+        return us;
+    }
+
+    uint64_t millis() const {
+        return micros() / 1000;
+    }
+
+    //* A millisecond clock for `EventTimer` and `CustomEventManager`
+    std::function<uint64_t()> millisClock() {
+        return [this]() { return millis(); };
+    }
+};
+
+/**
+ * @brief Outcome of `EventReplayer::replay`
+ * @param records The records applied
+ * @param messages The records that fed a buffer
+ * @param notifications The records that notified observers
+ * @param skipped The records whose subject could not be resolved, or whose
+ * payload is corrupt
+ * @param seconds The wall time of the replay
+ * @param recordsPerSecond The replay throughput
+ * @note Latencies are in microseconds, from the time a record was due to the
+ * time it was applied and the strategies handled.
+ */
+struct ReplayReport {
+    uint64_t records = 0;
+    uint64_t messages = 0;
+    uint64_t notifications = 0;
+    uint64_t skipped = 0;
+    double seconds = 0;
+    double recordsPerSecond = 0;
+    double latencyP50 = 0;
+    double latencyP90 = 0;
+    double latencyP99 = 0;
+    double latencyP999 = 0;
+    double latencyMax = 0;
+};
+
+/**
+ * @brief Feeds a recording back into a `CustomEventManager`
+ * @tparam EnumT The Enum Type for the Event
+ * @note Subjects are resolved by the ID they were recorded with, by default
+ * among the manager's strategies. IDs are handed out in construction order,
+ * so building the strategies in the same order as the recorded run makes
+ * them match; otherwise pass a resolver or `setID` the strategies.
+ * @note Chunks are fed through one `FrameParser` per subject, created with
+ * the framing and size of the recorded parser.
+ * @note `tools/replay` replays a recording file on the host, see
+ * `[env:native_replay]`.
+ *
+ * @code
+ * ```
+ * Helpers::VirtualClock clock;
+ * auto manager = std::make_shared<Manager>("replay", clock.millisClock());
+ * // ... add the strategies
+ * Helpers::RecordingReader reader("/tmp/field.rec");
+ * Helpers::EventReplayer<EventID> replayer(*manager, clock);
+ * auto report = replayer.replay(reader, 0);  // as fast as possible
+ * ```
+ */
+template <typename EnumT>
+class EventReplayer {
+   public:
+    using Resolver_t = std::function<ISubject<EnumT>*(uint64_t subject)>;
+
+   private:
+    using WallClock_t = std::chrono::steady_clock;
+
+    CustomEventManager<EnumT>& manager;
+    VirtualClock& clock;
+    Resolver_t resolver;
+    std::unordered_map<uint64_t, std::unique_ptr<FrameParser> > parsers;
+
+    FrameParser& parserFor(const RecordedEvent& record) {
+        auto& parser = parsers[record.subject];
+        if (!parser) {
+            parser.reset(
+                new FrameParser(static_cast<MessageFraming_t>(record.key),
+                                static_cast<size_t>(record.event)));
+        }
+        return *parser;
+    }
+
+    //* Apply one record, false if its subject is unknown or its payload
+    //* corrupt
+    bool apply(const RecordedEvent& record, ReplayReport& report) {
+        ISubject<EnumT>* subject = resolver(record.subject);
+        if (!subject) {
+            return false;
+        }
+
+        if (record.type == EventRecorder::NOTIFY_ALL) {
+            subject->notifyAll(static_cast<EnumT>(record.event));
+            report.notifications++;
+            return true;
+        }
+        if (record.type == EventRecorder::NOTIFY) {
+            subject->notify(record.key, static_cast<EnumT>(record.event));
+            report.notifications++;
+            return true;
+        }
+
+        auto* buffer = dynamic_cast<MessageBuffer<EnumT>*>(subject);
+        if (!buffer) {
+            return false;
+        }
+        switch (record.type) {
+            case EventRecorder::ADD_MESSAGE: {
+                JsonDocument doc;
+                if (deserializeJson(doc, record.payload.data(),
+                                    record.payload.size())) {
+                    return false;
+                }
+                buffer->addMessage(doc);
+                break;
+            }
+            case EventRecorder::DESERIALIZE:
+                buffer->deserialize(record.payload);
+                break;
+            case EventRecorder::BATCH:
+                buffer->deserializeBatch(
+                    record.payload.data(), record.payload.size(),
+                    static_cast<MessageFraming_t>(record.key));
+                break;
+            case EventRecorder::CHUNK:
+                buffer->deserializeChunk(parserFor(record),
+                                         record.payload.data(),
+                                         record.payload.size());
+                break;
+            default:
+                return false;
+        }
+        report.messages++;
+        return true;
+    }
+
+    static double percentile(const std::vector<uint64_t>& sorted,
+                             double fraction) {
+        if (sorted.empty()) {
+            return 0;
+        }
+        size_t index = static_cast<size_t>(fraction * (sorted.size() - 1));
+        return sorted[index] / 1000.0;
+    }
+
+   public:
+    /**
+     * @brief Construct a new Event Replayer
+     * @param manager The manager to replay into
+     * @param clock The clock of the manager's timers, set to the recorded
+     * time of each record as it is applied
+     * @param resolver Maps recorded subject IDs to subjects, defaults to the
+     * manager's strategies
+     */
+    EventReplayer(CustomEventManager<EnumT>& manager, VirtualClock& clock,
+                  Resolver_t resolver = nullptr)
+        : manager(manager), clock(clock), resolver(std::move(resolver)) {
+        if (!this->resolver) {
+            this->resolver = [&manager](uint64_t id) -> ISubject<EnumT>* {
+                return manager.getStrategy(id).get();
+            };
+        }
+    }
+
+    /**
+     * @brief Replay a recording
+     * @param reader The recording
+     * @param speed 1 replays at the original pace, 2 twice as fast, 0 as fast
+     * as possible
+     * @param handle Call `handleStrategies()` after every record, so the
+     * latency includes the strategies consuming the message
+     * @return ReplayReport Throughput and latency percentiles
+     * @note Blocks until the end of the recording.
+     */
+    ReplayReport replay(RecordingReader& reader, double speed = 1.0,
+                        bool handle = true) {
+        ReplayReport report;
+        std::vector<uint64_t> latencies;
+        RecordedEvent record;
+        uint64_t clockBase = clock.micros();
+        auto start = WallClock_t::now();
+
+        while (reader.next(record)) {
+            auto due = WallClock_t::now();
+            if (speed > 0) {
+                due = start + std::chrono::duration_cast<WallClock_t::duration>(
+                                  std::chrono::duration<double, std::micro>(
+                                      record.time / speed));
+                std::this_thread::sleep_until(due);
+            }
+
+            clock.set(clockBase + record.time);
+            if (!apply(record, report)) {
+                report.skipped++;
+                continue;
+            }
+            if (handle) {
+                manager.handleStrategies();
+            }
+            report.records++;
+            latencies.push_back(
+                std::chrono::duration_cast<std::chrono::nanoseconds>(
+                    WallClock_t::now() - due)
+                    .count());
+        }
+
+        report.seconds =
+            std::chrono::duration<double>(WallClock_t::now() - start).count();
+        if (report.seconds > 0) {
+            report.recordsPerSecond = report.records / report.seconds;
+        }
+        std::sort(latencies.begin(), latencies.end());
+        report.latencyP50 = percentile(latencies, 0.5);
+        report.latencyP90 = percentile(latencies, 0.9);
+        report.latencyP99 = percentile(latencies, 0.99);
+        report.latencyP999 = percentile(latencies, 0.999);
+        report.latencyMax = percentile(latencies, 1.0);
+        return report;
+    }
+};
+}  // namespace Helpers
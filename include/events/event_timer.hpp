@@ -0,0 +1,173 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <helpers/observer.hpp>
+#include <helpers/timer_wheel.hpp>
+
+namespace Helpers {
+/**
+ * @brief Schedules `notify`/`notifyAll` calls on subjects after a delay or on
+ * a period
+ * @tparam EnumT The Enum Type for the Event
+ * @note Backed by a `TimerWheel`, so thousands of outstanding timers cost
+ * O(1) to schedule or cancel and `poll` only touches the timers that are due.
+ * @note Notifications are delivered from `poll`, with the timer unlocked, so
+ * observers may schedule or cancel timers from `update`.
+ * @note The clock is injectable for testing, it returns milliseconds.
+ *
+ * @code
+ * ```
+ * Helpers::EventTimer<EventID> timers;
+ * timers.notifyAfter(*strategy, 500, EventID::EVENT_1);
+ * auto heartbeat = timers.notifyEvery(*strategy, 1000, EventID::EVENT_2);
+ * // in loop()
+ * timers.poll();
+ * ```
+ */
+template <typename EnumT>
+class EventTimer {
+   public:
+    using Clock_t = std::function<uint64_t()>;
+    using TimerID_t = uint64_t;
+    static constexpr TimerID_t INVALID_TIMER = 0;
+
+   private:
+    struct TimedEvent {
+        ISubject<EnumT>* subject = nullptr;
+        EnumT event{};
+        uint64_t key = 0;
+        bool broadcast = true;
+    };
+
+    SemaphoreHandle_t mutex;
+    Clock_t clock;
+    uint32_t tickMs;
+    TimerWheel<TimedEvent> wheel;
+
+    static uint64_t steadyMillis() {
+        return std::chrono::duration_cast<std::chrono::milliseconds>(
+                   std::chrono::steady_clock::now().time_since_epoch())
+            .count();
+    }
+
+    uint64_t toTicks(uint32_t ms) const {
+        return (ms + tickMs - 1) / tickMs;
+    }
+
+    TimerID_t schedule(uint32_t delayMs, uint32_t periodMs,
+                       TimedEvent timedEvent) {
+        xSemaphoreTake(mutex, portMAX_DELAY);
+        uint64_t now = clock() / tickMs;
+        TimerID_t id = wheel.schedule(now + toTicks(delayMs),
+                                      toTicks(periodMs), timedEvent);
+        xSemaphoreGive(mutex);
+        return id;
+    }
+
+   public:
+    /**
+     * @brief Construct a new Event Timer
+     * @param tickMs The resolution of the timers in milliseconds
+     * @param clock Returns the current time in milliseconds
+     */
+    EventTimer(uint32_t tickMs = 1, Clock_t clock = steadyMillis)
+        : mutex(xSemaphoreCreateMutex()),
+          clock(clock),
+          tickMs(tickMs ? tickMs : 1),
+          wheel(this->clock() / this->tickMs) {}
+
+    virtual ~EventTimer() {
+        vSemaphoreDelete(mutex);
+    }
+
+    EventTimer(const EventTimer&) = delete;
+    EventTimer& operator=(const EventTimer&) = delete;
+
+    /**
+     * @brief Call `subject.notifyAll(event)` once, after `delayMs`
+     * @note The subject must outlive the timer or the timer be cancelled
+     */
+    TimerID_t notifyAfter(ISubject<EnumT>& subject, uint32_t delayMs,
+                          EnumT event) {
+        return schedule(delayMs, 0, {&subject, event, 0, true});
+    }
+
+    /**
+     * @brief Call `subject.notify(key, event)` once, after `delayMs`
+     */
+    TimerID_t notifyAfter(ISubject<EnumT>& subject, uint32_t delayMs,
+                          uint64_t key, EnumT event) {
+        return schedule(delayMs, 0, {&subject, event, key, false});
+    }
+
+    /**
+     * @brief Call `subject.notifyAll(event)` every `periodMs`
+     * @note Periods missed because `poll` was late are coalesced into a single
+     * notification
+     */
+    TimerID_t notifyEvery(ISubject<EnumT>& subject, uint32_t periodMs,
+                          EnumT event) {
+        return schedule(periodMs, periodMs, {&subject, event, 0, true});
+    }
+
+    /**
+     * @brief Call `subject.notify(key, event)` every `periodMs`
+     */
+    TimerID_t notifyEvery(ISubject<EnumT>& subject, uint32_t periodMs,
+                          uint64_t key, EnumT event) {
+        return schedule(periodMs, periodMs, {&subject, event, key, false});
+    }
+
+    /**
+     * @brief Cancel a pending timer
+     * @return true if the timer was still pending
+     */
+    bool cancel(TimerID_t id) {
+        xSemaphoreTake(mutex, portMAX_DELAY);
+        bool cancelled = wheel.cancel(id);
+        xSemaphoreGive(mutex);
+        return cancelled;
+    }
+
+    /**
+     * @brief Deliver every notification that is due
+     * @return size_t The number of notifications delivered
+     * @note Call this regularly, e.g. from `loop()`, `CustomEventManager`
+     * does so from `handleStrategies()`
+     * @note Timer notifications are not recorded by an `EventRecorder`, a
+     * replay reproduces them by running the timers on its virtual clock
+     */
+    size_t poll() {
+        EventRecorder::Suppress suppress;
+        size_t delivered = 0;
+        TimedEvent timedEvent;
+
+        xSemaphoreTake(mutex, portMAX_DELAY);
+        wheel.collect(clock() / tickMs);
+        while (wheel.popExpired(timedEvent)) {
+            xSemaphoreGive(mutex);
+            if (timedEvent.broadcast) {
+                timedEvent.subject->notifyAll(timedEvent.event);
+            } else {
+                timedEvent.subject->notify(timedEvent.key, timedEvent.event);
+            }
+            delivered++;
+            xSemaphoreTake(mutex, portMAX_DELAY);
+        }
+        xSemaphoreGive(mutex);
+        return delivered;
+    }
+
+    /**
+     * @brief The number of pending timers
+     */
+    size_t size() {
+        xSemaphoreTake(mutex, portMAX_DELAY);
+        size_t pending = wheel.size();
+        xSemaphoreGive(mutex);
+        return pending;
+    }
+};
+}  // namespace Helpers
@@ -0,0 +1,365 @@
+#pragma once
+#include <ArduinoJson.h>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <thread>
+#include <utility>
+#include <vector>
+#include "freertos/semphr.h"
+
+namespace Helpers {
+
+/**
+ * @brief Lag metrics of one consumer of a `BroadcastRing`
+ * @param slot The consumer's slot in the ring
+ * @param lag The messages published but not yet read
+ * @param peakLag The largest lag seen when the consumer polled
+ * @param consumed The messages read since the consumer subscribed, modulo
+ * 2^32
+ */
+struct ConsumerLag {
+    size_t slot;
+    uint32_t lag;
+    uint32_t peakLag;
+    uint32_t consumed;
+};
+
+/**
+ * @brief A ring of messages written once and read by every consumer
+ * @tparam T The message type
+ * @note Disruptor style: each consumer reads through its own sequence cursor,
+ * in place, and a slot is only reused once the slowest consumer has passed
+ * it. Strategies sharing a stream then read the same message instead of each
+ * holding a copy in its `MessageBuffer`.
+ * @note Consumers are lock free. Sequences are 32 bit, which every target
+ * updates atomically without a lock, and wrap around safely: the capacity is
+ * a power of two and lags are unsigned differences. Producers are serialized
+ * by a mutex, a full ring makes `tryPublish` fail and `publish` wait for the
+ * slowest consumer.
+ * @note A consumer only sees messages published after it subscribed.
+ *
+ * @code
+ * ```
+ * Helpers::BroadcastRing<JsonDocument> ring(64);
+ * auto display = ring.subscribe();
+ * auto logger = ring.subscribe();
+ *
+ * ring.publish(message);
+ * display.poll([](const JsonDocument& message, uint32_t sequence) {
+ *     // ...
+ * });
+ * ```
+ */
+template <typename T = JsonDocument>
+class BroadcastRing {
+    static_assert(std::atomic<uint32_t>::is_always_lock_free,
+                  "BroadcastRing consumers must be lock free");
+
+    // one cache line per cursor, so consumers do not invalidate each other
+    struct alignas(64) Cursor {
+        std::atomic<bool> active{false};
+        std::atomic<uint32_t> next{0};
+        std::atomic<uint32_t> peakLag{0};
+        std::atomic<uint32_t> consumed{0};
+    };
+
+    SemaphoreHandle_t mutex;
+    std::vector<T> slots;
+    size_t mask;
+    std::unique_ptr<Cursor[]> cursors;
+    size_t maxConsumers;
+    alignas(64) std::atomic<uint32_t> published{0};
+    //* Producer side, under the mutex: the lowest cursor seen last time
+    uint32_t gate = 0;
+    std::atomic<uint32_t> fullCount{0};
+
+    static size_t roundUp(size_t capacity) {
+        size_t size = 1;
+        while (size < capacity) {
+            size <<= 1;
+        }
+        return size;
+    }
+
+    // the cursor of the active consumer furthest behind, `sequence` if there
+    // are none. Compared by lag, cursors themselves wrap around
+    uint32_t slowest(uint32_t sequence) const {
+        uint32_t maxLag = 0;
+        for (size_t i = 0; i < maxConsumers; i++) {
+            if (cursors[i].active.load(std::memory_order_acquire)) {
+                uint32_t lag =
+                    sequence - cursors[i].next.load(std::memory_order_acquire);
+                maxLag = lag > maxLag ? lag : maxLag;
+            }
+        }
+        return sequence - maxLag;
+    }
+
+   public:
+    /**
+     * @brief A consumer's cursor into the ring
+     * @note Unsubscribes when destroyed. The ring must outlive it, and a
+     * consumer must only be polled from one thread at a time.
+     */
+    class Consumer {
+        BroadcastRing* ring = nullptr;
+        size_t slot = 0;
+
+        friend class BroadcastRing;
+
+        Consumer(BroadcastRing* ring, size_t slot) : ring(ring), slot(slot) {}
+
+       public:
+        Consumer() = default;
+
+        Consumer(Consumer&& other) noexcept
+            : ring(other.ring), slot(other.slot) {
+            other.ring = nullptr;
+        }
+
+        Consumer& operator=(Consumer&& other) noexcept {
+            if (this != &other) {
+                unsubscribe();
+                ring = other.ring;
+                slot = other.slot;
+                other.ring = nullptr;
+            }
+            return *this;
+        }
+
+        Consumer(const Consumer&) = delete;
+        Consumer& operator=(const Consumer&) = delete;
+
+        ~Consumer() {
+            unsubscribe();
+        }
+
+        /**
+         * @brief false if the ring had no free consumer slot
+         */
+        bool valid() const {
+            return ring != nullptr;
+        }
+
+        /**
+         * @brief Stop gating the producer, the slot is freed for reuse
+         */
+        void unsubscribe() {
+            if (ring) {
+                ring->cursors[slot].active.store(false,
+                                                 std::memory_order_release);
+                ring = nullptr;
+            }
+        }
+
+        /**
+         * @brief Read a batch of messages in place
+         * @param handler Called as `handler(const T& message, uint32_t
+         * sequence)`, the reference is only valid during the call
+         * @param maxBatch The most messages to read
+         * @return size_t The number of messages read
+         * @note The slots are released to the producer once the whole batch
+         * has been handled
+         */
+        template <typename F>
+        size_t poll(F&& handler, size_t maxBatch = SIZE_MAX) {
+            if (!ring) {
+                return 0;
+            }
+            Cursor& cursor = ring->cursors[slot];
+            uint32_t next = cursor.next.load(std::memory_order_relaxed);
+            uint32_t available =
+                ring->published.load(std::memory_order_acquire) - next;
+            if (available > cursor.peakLag.load(std::memory_order_relaxed)) {
+                cursor.peakLag.store(available, std::memory_order_relaxed);
+            }
+            size_t count = available < maxBatch ? available : maxBatch;
+            for (size_t i = 0; i < count; i++) {
+                uint32_t sequence = next + static_cast<uint32_t>(i);
+                handler(static_cast<const T&>(
+                            ring->slots[sequence & ring->mask]),
+                        sequence);
+            }
+            if (count > 0) {
+                cursor.consumed.fetch_add(count, std::memory_order_relaxed);
+                cursor.next.store(next + count, std::memory_order_release);
+            }
+            return count;
+        }
+
+        /**
+         * @brief Copy out the next message
+         * @return false if there is none
+         */
+        bool read(T& message) {
+            return poll([&message](const T& next,
+                                   uint32_t) { message = next; },
+                        1) == 1;
+        }
+
+        /**
+         * @brief Skip every pending message
+         * @return uint32_t The number of messages skipped
+         */
+        uint32_t skip() {
+            if (!ring) {
+                return 0;
+            }
+            Cursor& cursor = ring->cursors[slot];
+            uint32_t end = ring->published.load(std::memory_order_acquire);
+            uint32_t skipped =
+                end - cursor.next.load(std::memory_order_relaxed);
+            cursor.next.store(end, std::memory_order_release);
+            return skipped;
+        }
+
+        /**
+         * @brief The messages published but not yet read
+         */
+        uint32_t lag() const {
+            if (!ring) {
+                return 0;
+            }
+            return ring->published.load(std::memory_order_acquire) -
+                   ring->cursors[slot].next.load(std::memory_order_acquire);
+        }
+
+        uint32_t getPeakLag() const {
+            return ring ? ring->cursors[slot].peakLag.load(
+                              std::memory_order_relaxed)
+                        : 0;
+        }
+
+        uint32_t getConsumed() const {
+            return ring ? ring->cursors[slot].consumed.load(
+                              std::memory_order_relaxed)
+                        : 0;
+        }
+    };
+
+    /**
+     * @brief Construct a new Broadcast Ring
+     * @param capacity The messages held, rounded up to a power of two
+     * @param maxConsumers The most consumers subscribed at once
+     */
+    explicit BroadcastRing(size_t capacity = 64, size_t maxConsumers = 8)
+        : mutex(xSemaphoreCreateMutex()),
+          slots(roundUp(capacity ? capacity : 1)),
+          mask(slots.size() - 1),
+          cursors(new Cursor[maxConsumers]),
+          maxConsumers(maxConsumers) {}
+
+    ~BroadcastRing() {
+        vSemaphoreDelete(mutex);
+    }
+
+    BroadcastRing(const BroadcastRing&) = delete;
+    BroadcastRing& operator=(const BroadcastRing&) = delete;
+
+    /**
+     * @brief Add a consumer, starting at the next published message
+     * @return Consumer Check `valid()`, every slot may be taken
+     */
+    Consumer subscribe() {
+        xSemaphoreTake(mutex, portMAX_DELAY);
+        for (size_t i = 0; i < maxConsumers; i++) {
+            if (!cursors[i].active.load(std::memory_order_acquire)) {
+                cursors[i].next.store(
+                    published.load(std::memory_order_relaxed),
+                    std::memory_order_relaxed);
+                cursors[i].peakLag.store(0, std::memory_order_relaxed);
+                cursors[i].consumed.store(0, std::memory_order_relaxed);
+                cursors[i].active.store(true, std::memory_order_release);
+                xSemaphoreGive(mutex);
+                return Consumer(this, i);
+            }
+        }
+        xSemaphoreGive(mutex);
+        return Consumer();
+    }
+
+    /**
+     * @brief Publish a message unless the slowest consumer still holds the
+     * slot it would overwrite
+     * @return false if the ring is full
+     */
+    template <typename U>
+    bool tryPublish(U&& message) {
+        xSemaphoreTake(mutex, portMAX_DELAY);
+        uint32_t sequence = published.load(std::memory_order_relaxed);
+        // only rescan the cursors once the cached gate is exhausted
+        if (sequence - gate >= slots.size()) {
+            gate = slowest(sequence);
+            if (sequence - gate >= slots.size()) {
+                xSemaphoreGive(mutex);
+                fullCount.fetch_add(1, std::memory_order_relaxed);
+                return false;
+            }
+        }
+        slots[sequence & mask] = std::forward<U>(message);
+        published.store(sequence + 1, std::memory_order_release);
+        xSemaphoreGive(mutex);
+        return true;
+    }
+
+    /**
+     * @brief Publish a message, waiting for the slowest consumer if the ring
+     * is full
+     */
+    template <typename U>
+    void publish(U&& message) {
+        // a failed attempt leaves the message untouched, it is only moved
+        // from once it is stored
+        while (!tryPublish(std::forward<U>(message))) {
+            std::this_thread::yield();
+        }
+    }
+
+    size_t capacity() const {
+        return slots.size();
+    }
+
+    /**
+     * @brief The number of messages published so far, modulo 2^32
+     */
+    uint32_t getPublished() const {
+        return published.load(std::memory_order_acquire);
+    }
+
+    /**
+     * @brief The number of times a publish found the ring full
+     */
+    uint32_t getFullCount() const {
+        return fullCount.load(std::memory_order_relaxed);
+    }
+
+    size_t consumers() const {
+        size_t count = 0;
+        for (size_t i = 0; i < maxConsumers; i++) {
+            count += cursors[i].active.load(std::memory_order_relaxed);
+        }
+        return count;
+    }
+
+    /**
+     * @brief Lag metrics of every active consumer
+     */
+    std::vector<ConsumerLag> lagMetrics() const {
+        std::vector<ConsumerLag> metrics;
+        uint32_t end = published.load(std::memory_order_acquire);
+        for (size_t i = 0; i < maxConsumers; i++) {
+            const Cursor& cursor = cursors[i];
+            if (!cursor.active.load(std::memory_order_acquire)) {
+                continue;
+            }
+            metrics.push_back(
+                {i, end - cursor.next.load(std::memory_order_acquire),
+                 cursor.peakLag.load(std::memory_order_relaxed),
+                 cursor.consumed.load(std::memory_order_relaxed)});
+        }
+        return metrics;
+    }
+};
+}  // namespace Helpers
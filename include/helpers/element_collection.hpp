@@ -0,0 +1,241 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <thread>
+#include <tuple>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include "id_interface.hpp"
+
+namespace Helpers {
+
+template <typename T, typename... Elements>
+struct ElementIndex;
+
+template <typename T, typename... Elements>
+struct ElementIndex<T, T, Elements...> : std::integral_constant<size_t, 0> {};
+
+template <typename T, typename First, typename... Elements>
+struct ElementIndex<T, First, Elements...>
+    : std::integral_constant<size_t,
+                             1 + ElementIndex<T, Elements...>::value> {};
+
+/**
+ * @brief Polymorphic collection storing each element type contiguously
+ * @tparam Elements The concrete element types, each deriving from `IId`
+ * @note Elements of the same type live in their own `std::vector`, so a
+ * visitor runs type by type over contiguous memory with its call resolved at
+ * compile time.
+ * @note Insertion and erase by ID are O(1): erase moves the last element of
+ * the segment into the freed slot. This reorders the segment and, like any
+ * insertion, invalidates references into it.
+ * @note IDs must be unique within the collection, inserting an element whose
+ * ID is already present replaces the previous element.
+ *
+ * @code
+ * ```
+ * Helpers::ElementCollection<Sensor, Actuator> components;
+ * components.emplace<Sensor>();
+ * components.forEach(Helpers::Overloaded{
+ *     [](Sensor& sensor) { ... },
+ *     [](Actuator& actuator) { ... },
+ * });
+ * ```
+ */
+template <typename... Elements>
+class ElementCollection {
+    static_assert(sizeof...(Elements) > 0, "At least one element type");
+    static_assert((std::is_base_of<IId, Elements>::value && ...),
+                  "Elements must derive from IId");
+
+    struct Location {
+        size_t type;
+        size_t index;
+    };
+
+    std::tuple<std::vector<Elements>...> segments;
+    std::unordered_map<uint64_t, Location> locations;
+
+    template <size_t I>
+    void eraseAt(size_t index) {
+        auto& segment = std::get<I>(segments);
+        if (index + 1 != segment.size()) {
+            segment[index] = std::move(segment.back());
+            locations[segment[index].getID()].index = index;
+        }
+        segment.pop_back();
+    }
+
+    template <size_t... I>
+    void eraseAt(size_t type, size_t index, std::index_sequence<I...>) {
+        // expands to a switch over the element types
+        ((type == I ? (eraseAt<I>(index), true) : false) || ...);
+    }
+
+    template <typename T>
+    T& insert(T&& element) {
+        using Element_t = typename std::decay<T>::type;
+        constexpr size_t type = ElementIndex<Element_t, Elements...>::value;
+
+        erase(element.getID());
+        auto& segment = std::get<type>(segments);
+        segment.push_back(std::forward<T>(element));
+        locations[segment.back().getID()] = {type, segment.size() - 1};
+        return segment.back();
+    }
+
+   public:
+    ElementCollection() = default;
+
+    /**
+     * @brief Construct an element at the end of its type's segment
+     * @return T& The stored element
+     */
+    template <typename T, typename... Args>
+    T& emplace(Args&&... args) {
+        return insert(T(std::forward<Args>(args)...));
+    }
+
+    /**
+     * @brief Add an element at the end of its type's segment
+     * @return T& The stored element
+     */
+    template <typename T>
+    T& add(T&& element) {
+        return insert(std::forward<T>(element));
+    }
+
+    /**
+     * @brief Remove the element with the given ID
+     * @param id The `IId` of the element
+     * @return true if an element was removed
+     */
+    bool erase(uint64_t id) {
+        auto location = locations.find(id);
+        if (location == locations.end()) {
+            return false;
+        }
+        Location erased = location->second;
+        locations.erase(location);
+        eraseAt(erased.type, erased.index,
+                std::index_sequence_for<Elements...>{});
+        return true;
+    }
+
+    /**
+     * @brief Find an element by ID
+     * @return T* The element, or `nullptr` if the ID is unknown or belongs to
+     * another type
+     */
+    template <typename T>
+    T* find(uint64_t id) {
+        constexpr size_t type = ElementIndex<T, Elements...>::value;
+        auto location = locations.find(id);
+        if (location == locations.end() || location->second.type != type) {
+            return nullptr;
+        }
+        return &std::get<type>(segments)[location->second.index];
+    }
+
+    bool contains(uint64_t id) const {
+        return locations.find(id) != locations.end();
+    }
+
+    /**
+     * @brief Get the contiguous storage of one element type
+     */
+    template <typename T>
+    std::vector<T>& segment() {
+        return std::get<std::vector<T> >(segments);
+    }
+
+    template <typename T>
+    const std::vector<T>& segment() const {
+        return std::get<std::vector<T> >(segments);
+    }
+
+    size_t size() const {
+        return locations.size();
+    }
+
+    bool empty() const {
+        return locations.empty();
+    }
+
+    void clear() {
+        std::apply([](auto&... segment) { (segment.clear(), ...); }, segments);
+        locations.clear();
+    }
+
+    /**
+     * @brief Reserve storage for `count` elements of type T
+     */
+    template <typename T>
+    void reserve(size_t count) {
+        segment<T>().reserve(count);
+        locations.reserve(size() + count);
+    }
+
+    /**
+     * @brief Visit every element, one type segment after another
+     * @param visitor A callable accepting every element type, e.g. an
+     * `Overloaded` set of lambdas
+     */
+    template <typename Visitor>
+    void forEach(Visitor&& visitor) {
+        std::apply(
+            [&visitor](auto&... segment) {
+                (..., [&visitor](auto& elements) {
+                    for (auto& element : elements) {
+                        visitor(element);
+                    }
+                }(segment));
+            },
+            segments);
+    }
+
+    /**
+     * @brief Visit every element, each non-empty type segment on its own
+     * thread
+     * @note The visitor is called concurrently for different element types,
+     * it must be safe to do so. The call returns once every segment is done.
+     * @note The calling thread visits one segment, a `std::thread` is
+     * started for each of the others on every call. On the ESP32 each is a
+     * FreeRTOS task, size their stacks with `esp_pthread_set_cfg`, and prefer
+     * `forEach` for small collections visited often.
+     */
+    template <typename Visitor>
+    void forEachParallel(Visitor&& visitor) {
+        std::vector<std::thread> workers;
+        workers.reserve(sizeof...(Elements));
+        //* The latest non-empty segment, left for the calling thread
+        std::function<void()> local;
+        std::apply(
+            [&visitor, &workers, &local](auto&... segment) {
+                (..., [&visitor, &workers, &local](auto& elements) {
+                    if (elements.empty()) {
+                        return;
+                    }
+                    if (local) {
+                        workers.emplace_back(std::move(local));
+                    }
+                    local = [&visitor, &elements]() {
+                        for (auto& element : elements) {
+                            visitor(element);
+                        }
+                    };
+                }(segment));
+            },
+            segments);
+        if (local) {
+            local();
+        }
+        for (auto& worker : workers) {
+            worker.join();
+        }
+    }
+};
+}  // namespace Helpers
@@ -14,7 +14,7 @@
  * };
  *
  * enum NewFruits {
- *  Apple,
+ *  Apple = Banana + 1,
  *  Pear
  * };
  *
@@ -25,6 +25,9 @@
 template <typename EnumT, typename BaseEnumT>
 class InheritEnum {
    public:
+    using Enum_t = EnumT;
+    using BaseEnum_t = BaseEnumT;
+
     InheritEnum() {}
     InheritEnum(EnumT e) : enum_(e) {}
 
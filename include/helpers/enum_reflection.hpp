@@ -0,0 +1,478 @@
+#pragma once
+#include <array>
+#include <cstddef>
+#include <optional>
+#include <string_view>
+#include <type_traits>
+#include "enum_inheritance.hpp"
+
+namespace Helpers {
+
+/**
+ * @brief Compile-time description of an enum
+ * @tparam EnumT The enum to describe
+ * @note Specialize with `EASYHELPERS_REFLECT_ENUM` rather than by hand
+ */
+template <typename EnumT>
+struct EnumReflection {
+    static constexpr bool reflected = false;
+};
+
+constexpr bool isEnumNameSpace(char c) {
+    return c == ' ' || c == '\t' || c == '\n' || c == '\r';
+}
+
+constexpr std::size_t countEnumNames(std::string_view list) {
+    std::size_t count = 1;
+    for (char c : list) {
+        if (c == ',') {
+            count++;
+        }
+    }
+    return count;
+}
+
+template <std::size_t N>
+constexpr std::array<std::string_view, N> splitEnumNames(
+    std::string_view list) {
+    std::array<std::string_view, N> names{};
+    std::size_t index = 0;
+    std::size_t start = 0;
+    for (std::size_t i = 0; i <= list.size(); i++) {
+        if (i != list.size() && list[i] != ',') {
+            continue;
+        }
+        std::string_view name = list.substr(start, i - start);
+        while (!name.empty() && isEnumNameSpace(name.front())) {
+            name.remove_prefix(1);
+        }
+        while (!name.empty() && isEnumNameSpace(name.back())) {
+            name.remove_suffix(1);
+        }
+        names[index++] = name;
+        start = i + 1;
+    }
+    return names;
+}
+
+template <std::size_t N, std::size_t M>
+constexpr std::array<std::string_view, N + M> joinEnumNames(
+    const std::array<std::string_view, N>& first,
+    const std::array<std::string_view, M>& second) {
+    std::array<std::string_view, N + M> names{};
+    for (std::size_t i = 0; i < N; i++) {
+        names[i] = first[i];
+    }
+    for (std::size_t i = 0; i < M; i++) {
+        names[N + i] = second[i];
+    }
+    return names;
+}
+
+template <typename EnumT>
+constexpr void requireReflection() {
+    static_assert(EnumReflection<EnumT>::reflected,
+                  "Enum is not reflected, see EASYHELPERS_REFLECT_ENUM");
+}
+
+/**
+ * @brief The integer value of an enumerator, also accepts an `InheritEnum`
+ */
+template <typename EnumT>
+constexpr long long enumInteger(EnumT value) {
+    if constexpr (std::is_enum<EnumT>::value) {
+        return static_cast<long long>(value);
+    } else {
+        return static_cast<long long>(
+            static_cast<typename EnumT::Enum_t>(value));
+    }
+}
+
+/**
+ * @brief The number of enumerators
+ */
+template <typename EnumT>
+constexpr std::size_t enumCount() {
+    requireReflection<EnumT>();
+    return EnumReflection<EnumT>::count;
+}
+
+/**
+ * @brief The dense, zero based, index of an enumerator
+ * @note Values outside of the reflected range map to `enumCount<EnumT>()`
+ */
+template <typename EnumT>
+constexpr std::size_t enumIndex(EnumT value) {
+    requireReflection<EnumT>();
+    long long index = enumInteger(value) - EnumReflection<EnumT>::first;
+    if (index < 0 || index >= static_cast<long long>(enumCount<EnumT>())) {
+        return enumCount<EnumT>();
+    }
+    return static_cast<std::size_t>(index);
+}
+
+template <typename EnumT>
+constexpr bool enumContains(EnumT value) {
+    return enumIndex(value) < enumCount<EnumT>();
+}
+
+/**
+ * @brief The enumerator at a dense index
+ */
+template <typename EnumT>
+constexpr EnumT enumValue(std::size_t index) {
+    requireReflection<EnumT>();
+    using Value_t =
+        typename std::conditional<std::is_enum<EnumT>::value, EnumT, int>::type;
+    return EnumT(static_cast<Value_t>(
+        static_cast<long long>(index) + EnumReflection<EnumT>::first));
+}
+
+/**
+ * @brief All enumerator names, in declaration order
+ */
+template <typename EnumT>
+constexpr const auto& enumNames() {
+    requireReflection<EnumT>();
+    return EnumReflection<EnumT>::names;
+}
+
+/**
+ * @brief The name of an enumerator, empty if the value is out of range
+ */
+template <typename EnumT>
+constexpr std::string_view enumName(EnumT value) {
+    std::size_t index = enumIndex(value);
+    if (index >= enumCount<EnumT>()) {
+        return {};
+    }
+    return enumNames<EnumT>()[index];
+}
+
+/**
+ * @brief Look an enumerator up by name
+ */
+template <typename EnumT>
+constexpr std::optional<EnumT> enumCast(std::string_view name) {
+    for (std::size_t i = 0; i < enumCount<EnumT>(); i++) {
+        if (enumNames<EnumT>()[i] == name) {
+            return enumValue<EnumT>(i);
+        }
+    }
+    return std::nullopt;
+}
+
+/**
+ * @brief A flat array with one slot per enumerator, indexed by the enum
+ * @note Handy for dispatch tables, counters and histograms sized at compile
+ * time
+ *
+ * @code
+ * ```
+ * Helpers::EnumArray<EventID, uint32_t> histogram{};
+ * histogram[EventID::EVENT_1]++;
+ * ```
+ */
+template <typename EnumT, typename T>
+struct EnumArray : public std::array<T, EnumReflection<EnumT>::count> {
+    using Base_t = std::array<T, EnumReflection<EnumT>::count>;
+    using Base_t::operator[];
+
+    constexpr T& operator[](EnumT value) {
+        return Base_t::operator[](enumIndex(value));
+    }
+
+    constexpr const T& operator[](EnumT value) const {
+        return Base_t::operator[](enumIndex(value));
+    }
+};
+
+//* Whether `values` are numbered densely from `first`, in order
+template <typename EnumT, std::size_t N>
+constexpr bool enumValuesDense(const EnumT (&values)[N], long long first) {
+    for (std::size_t i = 0; i < N; i++) {
+        if (enumInteger(values[i]) != first + static_cast<long long>(i)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * @brief Reflection of an `InheritEnum`, the base enumerators come first
+ * @note The derived enum must continue the numbering of its base, i.e. its
+ * first enumerator equals the number of base enumerators
+ */
+template <typename EnumT, typename BaseEnumT>
+struct EnumReflection<InheritEnum<EnumT, BaseEnumT> > {
+    using Base_t = EnumReflection<BaseEnumT>;
+    using Derived_t = EnumReflection<EnumT>;
+    static_assert(Base_t::reflected && Derived_t::reflected,
+                  "Both enums must be reflected");
+    static_assert(Derived_t::first == Base_t::first + Base_t::count,
+                  "The derived enum must continue the numbering of its base");
+    static_assert(std::is_same<typename std::underlying_type<EnumT>::type,
+                               typename std::underlying_type<
+                                   BaseEnumT>::type>::value,
+                  "Both enums must share their underlying type");
+
+    static constexpr bool reflected = true;
+    static constexpr long long first = Base_t::first;
+    static constexpr std::size_t count = Base_t::count + Derived_t::count;
+    static constexpr std::array<std::string_view, count> names =
+        joinEnumNames(Base_t::names, Derived_t::names);
+};
+
+}  // namespace Helpers
+
+// EASYHELPERS_ENUM_VALUES(EnumT, a, b, ...) expands to `EnumT::a, EnumT::b,
+// ...`, so that every listed name must be an enumerator
+#define EASYHELPERS_ENUM_EXPAND(x) x
+#define EASYHELPERS_ENUM_CAT_(a, b) a##b
+#define EASYHELPERS_ENUM_CAT(a, b) EASYHELPERS_ENUM_CAT_(a, b)
+#define EASYHELPERS_ENUM_NTH(                                              \
+    _1, _2, _3, _4, _5, _6, _7, _8, _9, _10, _11, _12, _13, _14, _15, _16, \
+    _17, _18, _19, _20, _21, _22, _23, _24, _25, _26, _27, _28, _29, _30,  \
+    _31, _32, _33, _34, _35, _36, _37, _38, _39, _40, _41, _42, _43, _44,  \
+    _45, _46, _47, _48, _49, _50, _51, _52, _53, _54, _55, _56, _57, _58,  \
+    _59, _60, _61, _62, _63, _64, n, ...) n
+#define EASYHELPERS_ENUM_COUNT(...)                                          \
+    EASYHELPERS_ENUM_EXPAND(EASYHELPERS_ENUM_NTH(                            \
+        __VA_ARGS__, 64, 63, 62, 61, 60, 59, 58, 57, 56, 55, 54, 53, 52, 51, \
+        50, 49, 48, 47, 46, 45, 44, 43, 42, 41, 40, 39, 38, 37, 36, 35, 34,  \
+        33, 32, 31, 30, 29, 28, 27, 26, 25, 24, 23, 22, 21, 20, 19, 18, 17,  \
+        16, 15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1, 0))
+#define EASYHELPERS_ENUM_VALUES_1(EnumT, name) EnumT::name,
+#define EASYHELPERS_ENUM_VALUES_2(EnumT, name, ...) \
+    EnumT::name,                                    \
+        EASYHELPERS_ENUM_EXPAND(EASYHELPERS_ENUM_VALUES_1(EnumT, __VA_ARGS__))
+#define EASYHELPERS_ENUM_VALUES_3(EnumT, name, ...) \
+    EnumT::name,                                    \
+        EASYHELPERS_ENUM_EXPAND(EASYHELPERS_ENUM_VALUES_2(EnumT, __VA_ARGS__))
+#define EASYHELPERS_ENUM_VALUES_4(EnumT, name, ...) \
+    EnumT::name,                                    \
+        EASYHELPERS_ENUM_EXPAND(EASYHELPERS_ENUM_VALUES_3(EnumT, __VA_ARGS__))
+#define EASYHELPERS_ENUM_VALUES_5(EnumT, name, ...) \
+    EnumT::name,                                    \
+        EASYHELPERS_ENUM_EXPAND(EASYHELPERS_ENUM_VALUES_4(EnumT, __VA_ARGS__))
+#define EASYHELPERS_ENUM_VALUES_6(EnumT, name, ...) \
+    EnumT::name,                                    \
+        EASYHELPERS_ENUM_EXPAND(EASYHELPERS_ENUM_VALUES_5(EnumT, __VA_ARGS__))
+#define EASYHELPERS_ENUM_VALUES_7(EnumT, name, ...) \
+    EnumT::name,                                    \
+        EASYHELPERS_ENUM_EXPAND(EASYHELPERS_ENUM_VALUES_6(EnumT, __VA_ARGS__))
+#define EASYHELPERS_ENUM_VALUES_8(EnumT, name, ...) \
+    EnumT::name,                                    \
+        EASYHELPERS_ENUM_EXPAND(EASYHELPERS_ENUM_VALUES_7(EnumT, __VA_ARGS__))
+#define EASYHELPERS_ENUM_VALUES_9(EnumT, name, ...) \
+    EnumT::name,                                    \
+        EASYHELPERS_ENUM_EXPAND(EASYHELPERS_ENUM_VALUES_8(EnumT, __VA_ARGS__))
+#define EASYHELPERS_ENUM_VALUES_10(EnumT, name, ...) \
+    EnumT::name,                                     \
+        EASYHELPERS_ENUM_EXPAND(EASYHELPERS_ENUM_VALUES_9(EnumT, __VA_ARGS__))
+#define EASYHELPERS_ENUM_VALUES_11(EnumT, name, ...) \
+    EnumT::name,                                     \
+        EASYHELPERS_ENUM_EXPAND(EASYHELPERS_ENUM_VALUES_10(EnumT, __VA_ARGS__))
+#define EASYHELPERS_ENUM_VALUES_12(EnumT, name, ...) \
+    EnumT::name,                                     \
+        EASYHELPERS_ENUM_EXPAND(EASYHELPERS_ENUM_VALUES_11(EnumT, __VA_ARGS__))
+#define EASYHELPERS_ENUM_VALUES_13(EnumT, name, ...) \
+    EnumT::name,                                     \
+        EASYHELPERS_ENUM_EXPAND(EASYHELPERS_ENUM_VALUES_12(EnumT, __VA_ARGS__))
+#define EASYHELPERS_ENUM_VALUES_14(EnumT, name, ...) \
+    EnumT::name,                                     \
+        EASYHELPERS_ENUM_EXPAND(EASYHELPERS_ENUM_VALUES_13(EnumT, __VA_ARGS__))
+#define EASYHELPERS_ENUM_VALUES_15(EnumT, name, ...) \
+    EnumT::name,                                     \
+        EASYHELPERS_ENUM_EXPAND(EASYHELPERS_ENUM_VALUES_14(EnumT, __VA_ARGS__))
+#define EASYHELPERS_ENUM_VALUES_16(EnumT, name, ...) \
+    EnumT::name,                                     \
+        EASYHELPERS_ENUM_EXPAND(EASYHELPERS_ENUM_VALUES_15(EnumT, __VA_ARGS__))
+#define EASYHELPERS_ENUM_VALUES_17(EnumT, name, ...) \
+    EnumT::name,                                     \
+        EASYHELPERS_ENUM_EXPAND(EASYHELPERS_ENUM_VALUES_16(EnumT, __VA_ARGS__))
+#define EASYHELPERS_ENUM_VALUES_18(EnumT, name, ...) \
+    EnumT::name,                                     \
+        EASYHELPERS_ENUM_EXPAND(EASYHELPERS_ENUM_VALUES_17(EnumT, __VA_ARGS__))
+#define EASYHELPERS_ENUM_VALUES_19(EnumT, name, ...) \
+    EnumT::name,                                     \
+        EASYHELPERS_ENUM_EXPAND(EASYHELPERS_ENUM_VALUES_18(EnumT, __VA_ARGS__))
+#define EASYHELPERS_ENUM_VALUES_20(EnumT, name, ...) \
+    EnumT::name,                                     \
+        EASYHELPERS_ENUM_EXPAND(EASYHELPERS_ENUM_VALUES_19(EnumT, __VA_ARGS__))
+#define EASYHELPERS_ENUM_VALUES_21(EnumT, name, ...) \
+    EnumT::name,                                     \
+        EASYHELPERS_ENUM_EXPAND(EASYHELPERS_ENUM_VALUES_20(EnumT, __VA_ARGS__))
+#define EASYHELPERS_ENUM_VALUES_22(EnumT, name, ...) \
+    EnumT::name,                                     \
+        EASYHELPERS_ENUM_EXPAND(EASYHELPERS_ENUM_VALUES_21(EnumT, __VA_ARGS__))
+#define EASYHELPERS_ENUM_VALUES_23(EnumT, name, ...) \
+    EnumT::name,                                     \
+        EASYHELPERS_ENUM_EXPAND(EASYHELPERS_ENUM_VALUES_22(EnumT, __VA_ARGS__))
+#define EASYHELPERS_ENUM_VALUES_24(EnumT, name, ...) \
+    EnumT::name,                                     \
+        EASYHELPERS_ENUM_EXPAND(EASYHELPERS_ENUM_VALUES_23(EnumT, __VA_ARGS__))
+#define EASYHELPERS_ENUM_VALUES_25(EnumT, name, ...) \
+    EnumT::name,                                     \
+        EASYHELPERS_ENUM_EXPAND(EASYHELPERS_ENUM_VALUES_24(EnumT, __VA_ARGS__))
+#define EASYHELPERS_ENUM_VALUES_26(EnumT, name, ...) \
+    EnumT::name,                                     \
+        EASYHELPERS_ENUM_EXPAND(EASYHELPERS_ENUM_VALUES_25(EnumT, __VA_ARGS__))
+#define EASYHELPERS_ENUM_VALUES_27(EnumT, name, ...) \
+    EnumT::name,                                     \
+        EASYHELPERS_ENUM_EXPAND(EASYHELPERS_ENUM_VALUES_26(EnumT, __VA_ARGS__))
+#define EASYHELPERS_ENUM_VALUES_28(EnumT, name, ...) \
+    EnumT::name,                                     \
+        EASYHELPERS_ENUM_EXPAND(EASYHELPERS_ENUM_VALUES_27(EnumT, __VA_ARGS__))
+#define EASYHELPERS_ENUM_VALUES_29(EnumT, name, ...) \
+    EnumT::name,                                     \
+        EASYHELPERS_ENUM_EXPAND(EASYHELPERS_ENUM_VALUES_28(EnumT, __VA_ARGS__))
+#define EASYHELPERS_ENUM_VALUES_30(EnumT, name, ...) \
+    EnumT::name,                                     \
+        EASYHELPERS_ENUM_EXPAND(EASYHELPERS_ENUM_VALUES_29(EnumT, __VA_ARGS__))
+#define EASYHELPERS_ENUM_VALUES_31(EnumT, name, ...) \
+    EnumT::name,                                     \
+        EASYHELPERS_ENUM_EXPAND(EASYHELPERS_ENUM_VALUES_30(EnumT, __VA_ARGS__))
+#define EASYHELPERS_ENUM_VALUES_32(EnumT, name, ...) \
+    EnumT::name,                                     \
+        EASYHELPERS_ENUM_EXPAND(EASYHELPERS_ENUM_VALUES_31(EnumT, __VA_ARGS__))
+#define EASYHELPERS_ENUM_VALUES_33(EnumT, name, ...) \
+    EnumT::name,                                     \
+        EASYHELPERS_ENUM_EXPAND(EASYHELPERS_ENUM_VALUES_32(EnumT, __VA_ARGS__))
+#define EASYHELPERS_ENUM_VALUES_34(EnumT, name, ...) \
+    EnumT::name,                                     \
+        EASYHELPERS_ENUM_EXPAND(EASYHELPERS_ENUM_VALUES_33(EnumT, __VA_ARGS__))
+#define EASYHELPERS_ENUM_VALUES_35(EnumT, name, ...) \
+    EnumT::name,                                     \
+        EASYHELPERS_ENUM_EXPAND(EASYHELPERS_ENUM_VALUES_34(EnumT, __VA_ARGS__))
+#define EASYHELPERS_ENUM_VALUES_36(EnumT, name, ...) \
+    EnumT::name,                                     \
+        EASYHELPERS_ENUM_EXPAND(EASYHELPERS_ENUM_VALUES_35(EnumT, __VA_ARGS__))
+#define EASYHELPERS_ENUM_VALUES_37(EnumT, name, ...) \
+    EnumT::name,                                     \
+        EASYHELPERS_ENUM_EXPAND(EASYHELPERS_ENUM_VALUES_36(EnumT, __VA_ARGS__))
+#define EASYHELPERS_ENUM_VALUES_38(EnumT, name, ...) \
+    EnumT::name,                                     \
+        EASYHELPERS_ENUM_EXPAND(EASYHELPERS_ENUM_VALUES_37(EnumT, __VA_ARGS__))
+#define EASYHELPERS_ENUM_VALUES_39(EnumT, name, ...) \
+    EnumT::name,                                     \
+        EASYHELPERS_ENUM_EXPAND(EASYHELPERS_ENUM_VALUES_38(EnumT, __VA_ARGS__))
+#define EASYHELPERS_ENUM_VALUES_40(EnumT, name, ...) \
+    EnumT::name,                                     \
+        EASYHELPERS_ENUM_EXPAND(EASYHELPERS_ENUM_VALUES_39(EnumT, __VA_ARGS__))
+#define EASYHELPERS_ENUM_VALUES_41(EnumT, name, ...) \
+    EnumT::name,                                     \
+        EASYHELPERS_ENUM_EXPAND(EASYHELPERS_ENUM_VALUES_40(EnumT, __VA_ARGS__))
+#define EASYHELPERS_ENUM_VALUES_42(EnumT, name, ...) \
+    EnumT::name,                                     \
+        EASYHELPERS_ENUM_EXPAND(EASYHELPERS_ENUM_VALUES_41(EnumT, __VA_ARGS__))
+#define EASYHELPERS_ENUM_VALUES_43(EnumT, name, ...) \
+    EnumT::name,                                     \
+        EASYHELPERS_ENUM_EXPAND(EASYHELPERS_ENUM_VALUES_42(EnumT, __VA_ARGS__))
+#define EASYHELPERS_ENUM_VALUES_44(EnumT, name, ...) \
+    EnumT::name,                                     \
+        EASYHELPERS_ENUM_EXPAND(EASYHELPERS_ENUM_VALUES_43(EnumT, __VA_ARGS__))
+#define EASYHELPERS_ENUM_VALUES_45(EnumT, name, ...) \
+    EnumT::name,                                     \
+        EASYHELPERS_ENUM_EXPAND(EASYHELPERS_ENUM_VALUES_44(EnumT, __VA_ARGS__))
+#define EASYHELPERS_ENUM_VALUES_46(EnumT, name, ...) \
+    EnumT::name,                                     \
+        EASYHELPERS_ENUM_EXPAND(EASYHELPERS_ENUM_VALUES_45(EnumT, __VA_ARGS__))
+#define EASYHELPERS_ENUM_VALUES_47(EnumT, name, ...) \
+    EnumT::name,                                     \
+        EASYHELPERS_ENUM_EXPAND(EASYHELPERS_ENUM_VALUES_46(EnumT, __VA_ARGS__))
+#define EASYHELPERS_ENUM_VALUES_48(EnumT, name, ...) \
+    EnumT::name,                                     \
+        EASYHELPERS_ENUM_EXPAND(EASYHELPERS_ENUM_VALUES_47(EnumT, __VA_ARGS__))
+#define EASYHELPERS_ENUM_VALUES_49(EnumT, name, ...) \
+    EnumT::name,                                     \
+        EASYHELPERS_ENUM_EXPAND(EASYHELPERS_ENUM_VALUES_48(EnumT, __VA_ARGS__))
+#define EASYHELPERS_ENUM_VALUES_50(EnumT, name, ...) \
+    EnumT::name,                                     \
+        EASYHELPERS_ENUM_EXPAND(EASYHELPERS_ENUM_VALUES_49(EnumT, __VA_ARGS__))
+#define EASYHELPERS_ENUM_VALUES_51(EnumT, name, ...) \
+    EnumT::name,                                     \
+        EASYHELPERS_ENUM_EXPAND(EASYHELPERS_ENUM_VALUES_50(EnumT, __VA_ARGS__))
+#define EASYHELPERS_ENUM_VALUES_52(EnumT, name, ...) \
+    EnumT::name,                                     \
+        EASYHELPERS_ENUM_EXPAND(EASYHELPERS_ENUM_VALUES_51(EnumT, __VA_ARGS__))
+#define EASYHELPERS_ENUM_VALUES_53(EnumT, name, ...) \
+    EnumT::name,                                     \
+        EASYHELPERS_ENUM_EXPAND(EASYHELPERS_ENUM_VALUES_52(EnumT, __VA_ARGS__))
+#define EASYHELPERS_ENUM_VALUES_54(EnumT, name, ...) \
+    EnumT::name,                                     \
+        EASYHELPERS_ENUM_EXPAND(EASYHELPERS_ENUM_VALUES_53(EnumT, __VA_ARGS__))
+#define EASYHELPERS_ENUM_VALUES_55(EnumT, name, ...) \
+    EnumT::name,                                     \
+        EASYHELPERS_ENUM_EXPAND(EASYHELPERS_ENUM_VALUES_54(EnumT, __VA_ARGS__))
+#define EASYHELPERS_ENUM_VALUES_56(EnumT, name, ...) \
+    EnumT::name,                                     \
+        EASYHELPERS_ENUM_EXPAND(EASYHELPERS_ENUM_VALUES_55(EnumT, __VA_ARGS__))
+#define EASYHELPERS_ENUM_VALUES_57(EnumT, name, ...) \
+    EnumT::name,                                     \
+        EASYHELPERS_ENUM_EXPAND(EASYHELPERS_ENUM_VALUES_56(EnumT, __VA_ARGS__))
+#define EASYHELPERS_ENUM_VALUES_58(EnumT, name, ...) \
+    EnumT::name,                                     \
+        EASYHELPERS_ENUM_EXPAND(EASYHELPERS_ENUM_VALUES_57(EnumT, __VA_ARGS__))
+#define EASYHELPERS_ENUM_VALUES_59(EnumT, name, ...) \
+    EnumT::name,                                     \
+        EASYHELPERS_ENUM_EXPAND(EASYHELPERS_ENUM_VALUES_58(EnumT, __VA_ARGS__))
+#define EASYHELPERS_ENUM_VALUES_60(EnumT, name, ...) \
+    EnumT::name,                                     \
+        EASYHELPERS_ENUM_EXPAND(EASYHELPERS_ENUM_VALUES_59(EnumT, __VA_ARGS__))
+#define EASYHELPERS_ENUM_VALUES_61(EnumT, name, ...) \
+    EnumT::name,                                     \
+        EASYHELPERS_ENUM_EXPAND(EASYHELPERS_ENUM_VALUES_60(EnumT, __VA_ARGS__))
+#define EASYHELPERS_ENUM_VALUES_62(EnumT, name, ...) \
+    EnumT::name,                                     \
+        EASYHELPERS_ENUM_EXPAND(EASYHELPERS_ENUM_VALUES_61(EnumT, __VA_ARGS__))
+#define EASYHELPERS_ENUM_VALUES_63(EnumT, name, ...) \
+    EnumT::name,                                     \
+        EASYHELPERS_ENUM_EXPAND(EASYHELPERS_ENUM_VALUES_62(EnumT, __VA_ARGS__))
+#define EASYHELPERS_ENUM_VALUES_64(EnumT, name, ...) \
+    EnumT::name,                                     \
+        EASYHELPERS_ENUM_EXPAND(EASYHELPERS_ENUM_VALUES_63(EnumT, __VA_ARGS__))
+#define EASYHELPERS_ENUM_VALUES(EnumT, ...)       \
+    EASYHELPERS_ENUM_EXPAND(EASYHELPERS_ENUM_CAT( \
+        EASYHELPERS_ENUM_VALUES_,                 \
+        EASYHELPERS_ENUM_COUNT(__VA_ARGS__))(EnumT, __VA_ARGS__))
+
+/**
+ * @brief Reflect an enum whose enumerators are numbered densely from `First`
+ * @note Invoke at global scope, list the enumerators in declaration order
+ * without initializers or trailing comma, at most 64 of them
+ * @note Every name is checked against the enum: a misspelled or removed
+ * enumerator does not compile, and neither does a list out of declaration
+ * order or an enum with gaps in its numbering
+ *
+ * @code
+ * ```
+ * enum class EventID { EVENT_1, EVENT_2 };
+ * EASYHELPERS_REFLECT_ENUM(EventID, EVENT_1, EVENT_2);
+ *
+ * static_assert(Helpers::enumCount<EventID>() == 2);
+ * Helpers::enumName(EventID::EVENT_2);  // "EVENT_2"
+ * ```
+ */
+#define EASYHELPERS_REFLECT_ENUM_FROM(EnumT, First, ...)                      \
+    template <>                                                               \
+    struct Helpers::EnumReflection<EnumT> {                                   \
+        static constexpr bool reflected = true;                               \
+        static constexpr long long first = First;                             \
+        static constexpr EnumT values[] = {                                   \
+            EASYHELPERS_ENUM_VALUES(EnumT, __VA_ARGS__)};                     \
+        static constexpr std::size_t count = sizeof(values) / sizeof(EnumT);  \
+        static_assert(Helpers::enumValuesDense(values, first),                \
+                      "The enumerators must be listed in declaration order "  \
+                      "and numbered densely from First");                     \
+        static_assert(Helpers::countEnumNames(#__VA_ARGS__) == count,         \
+                      "Enumerator names must be plain identifiers");          \
+        static constexpr std::array<std::string_view, count> names =          \
+            Helpers::splitEnumNames<count>(#__VA_ARGS__);                     \
+    }
+
+/**
+ * @brief Reflect an enum whose enumerators are numbered densely from 0
+ */
+#define EASYHELPERS_REFLECT_ENUM(EnumT, ...) \
+    EASYHELPERS_REFLECT_ENUM_FROM(EnumT, 0, __VA_ARGS__)
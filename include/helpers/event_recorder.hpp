@@ -0,0 +1,241 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <functional>
+#include <istream>
+#include <memory>
+#include <ostream>
+#include <string>
+#include <type_traits>
+#include <vector>
+#include "freertos/semphr.h"
+#include "id_interface.hpp"
+#include "message_schema.hpp"
+
+namespace Helpers {
+
+/**
+ * @brief One captured call, see `EventRecorder::RecordType_e`
+ * @param time Microseconds since the previous record
+ * @param subject The `IId` of the subject, 0 for subjects without one
+ * @param key The key of `notify`, the framing of batches and chunks
+ * @param event The event, or the parser's maximum frame size of chunks
+ * @param payload The message bytes
+ */
+struct RecordedEvent {
+    uint8_t type = 0;
+    uint64_t time = 0;
+    uint64_t subject = 0;
+    uint64_t key = 0;
+    int64_t event = 0;
+    std::string payload;
+};
+}  // namespace Helpers
+
+EASYHELPERS_MESSAGE_SCHEMA(Helpers::RecordedEvent, type, time, subject, key,
+                           event, payload);
+
+namespace Helpers {
+
+/**
+ * @brief Captures `MessageBuffer` payloads and `ISubject` notifications into
+ * a compact file, for `EventReplayer` to play back
+ * @note Install it with `setActive`, the hooks then cost a single atomic load
+ * while no recorder is active.
+ * @note Records are schema encoded: a length, then varint fields, with the
+ * time stored as a delta to the previous record. Notifications sent by a
+ * buffer as part of a recorded call are not recorded again, and
+ * notifications carrying a payload are not recorded.
+ *
+ * @code
+ * ```
+ * Helpers::EventRecorder recorder("/tmp/field.rec");
+ * Helpers::EventRecorder::setActive(&recorder);
+ * // ... run
+ * Helpers::EventRecorder::setActive(nullptr);
+ * ```
+ */
+class EventRecorder {
+   public:
+    enum RecordType_e : uint8_t {
+        //* `addMessage`, the payload is the document serialized as JSON
+        ADD_MESSAGE,
+        //* `deserialize`, the payload is the raw input
+        DESERIALIZE,
+        //* `deserializeBatch`, the key holds the framing
+        BATCH,
+        //* `deserializeChunk`, the key holds the framing and the event the
+        //* maximum frame size of the parser
+        CHUNK,
+        NOTIFY_ALL,
+        NOTIFY,
+    };
+
+    //* Returns microseconds
+    using Clock_t = std::function<uint64_t()>;
+
+    /**
+     * @brief Suppress recording on this thread while the guard lives
+     * @note Used by buffers so that the notification implied by a recorded
+     * call is not recorded twice
+     */
+    class Suppress {
+       public:
+        Suppress();
+        ~Suppress();
+        Suppress(const Suppress&) = delete;
+        Suppress& operator=(const Suppress&) = delete;
+    };
+
+    class Active;
+
+   private:
+    inline static std::atomic<EventRecorder*> activeRecorder{nullptr};
+    //* Hooks between reading `activeRecorder` and returning from `record`
+    inline static std::atomic<uint32_t> inFlight{0};
+
+    SemaphoreHandle_t mutex;
+    std::unique_ptr<std::ofstream> file;
+    std::ostream* out;
+    Clock_t clock;
+    uint64_t lastTime;
+    uint64_t recordCount = 0;
+    uint64_t byteCount = 0;
+    std::vector<uint8_t> encoded;
+    RecordedEvent scratch;
+
+    static uint64_t steadyMicros();
+    static bool suppressed();
+    void writeHeader();
+
+   public:
+    static constexpr char MAGIC[4] = {'E', 'H', 'R', 'C'};
+    static constexpr uint8_t VERSION = 1;
+
+    /**
+     * @brief Record into a stream
+     * @param clock Returns the current time in microseconds
+     */
+    explicit EventRecorder(std::ostream& out, Clock_t clock = steadyMicros);
+
+    /**
+     * @brief Record into a file, truncating it
+     * @note Check `good()` for errors opening the file
+     */
+    explicit EventRecorder(const std::string& path,
+                           Clock_t clock = steadyMicros);
+    ~EventRecorder();
+
+    EventRecorder(const EventRecorder&) = delete;
+    EventRecorder& operator=(const EventRecorder&) = delete;
+
+    /**
+     * @brief Route the hooks to `recorder`, `nullptr` stops recording
+     * @note The recorder is not owned, it must outlive its activation
+     */
+    static void setActive(EventRecorder* recorder) {
+        activeRecorder.store(recorder, std::memory_order_release);
+    }
+
+    /**
+     * @brief The recorder the hooks should use, empty if none or if
+     * recording is suppressed on this thread
+     * @note Keeps the recorder from being destroyed until the returned handle
+     * goes out of scope
+     */
+    static Active active();
+
+    /**
+     * @brief The subject ID recorded for `self`, its `IId` if it has one
+     */
+    template <typename T>
+    static uint64_t subjectID(const T* self) {
+        if constexpr (std::is_polymorphic<T>::value) {
+            const IId* id = dynamic_cast<const IId*>(self);
+            return id ? id->getID() : 0;
+        } else {
+            return 0;
+        }
+    }
+
+    void record(RecordType_e type, uint64_t subject, uint64_t key,
+                int64_t event, const char* payload = nullptr,
+                size_t length = 0);
+
+    void flush();
+
+    bool good() const {
+        return out->good();
+    }
+
+    uint64_t records() const {
+        return recordCount;
+    }
+
+    //* Bytes written, including the file header
+    uint64_t bytes() const {
+        return byteCount;
+    }
+};
+
+/**
+ * @brief The active recorder, pinned while the handle lives
+ * @note `~EventRecorder` deactivates the recorder, then waits for the
+ * handles to it to be released
+ */
+class EventRecorder::Active {
+    EventRecorder* recorder;
+
+   public:
+    Active();
+    ~Active();
+    Active(const Active&) = delete;
+    Active& operator=(const Active&) = delete;
+
+    explicit operator bool() const {
+        return recorder != nullptr;
+    }
+
+    EventRecorder* operator->() const {
+        return recorder;
+    }
+};
+
+inline EventRecorder::Active EventRecorder::active() {
+    return Active();
+}
+
+/**
+ * @brief Reads back the records written by an `EventRecorder`
+ */
+class RecordingReader {
+    std::unique_ptr<std::ifstream> file;
+    std::istream* in;
+    bool valid = false;
+    uint64_t time = 0;
+    std::vector<uint8_t> encoded;
+
+    void readHeader();
+
+   public:
+    explicit RecordingReader(std::istream& in);
+    explicit RecordingReader(const std::string& path);
+
+    /**
+     * @brief false if the input could not be opened or is not a recording
+     */
+    bool good() const {
+        return valid;
+    }
+
+    /**
+     * @brief Read the next record
+     * @param record Receives the record, with `time` made absolute:
+     * microseconds since the first record
+     * @return false at the end of the recording or on a corrupt record
+     */
+    bool next(RecordedEvent& record);
+};
+}  // namespace Helpers
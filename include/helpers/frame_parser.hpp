@@ -0,0 +1,356 @@
+#pragma once
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+namespace Helpers {
+
+/**
+ * @brief Framing used by a stream of messages
+ * @note FRAMING_NDJSON - one document per line, `\r\n` and blank lines are
+ * tolerated
+ * @note FRAMING_LENGTH_PREFIXED - each document is preceded by its size as a
+ * 32-bit big-endian unsigned integer
+ * @note FRAMING_COBS - each document is COBS encoded and terminated by a
+ * `0x00` byte
+ */
+enum MessageFraming_e : uint8_t {
+    FRAMING_NDJSON,
+    FRAMING_LENGTH_PREFIXED,
+    FRAMING_COBS,
+};
+using MessageFraming_t = MessageFraming_e;
+
+/**
+ * @brief Resumable parser splitting a byte stream into frames
+ * @note Chunks may be split at any byte. A frame that lies entirely inside
+ * one chunk is handed out as a pointer into that chunk, only frames straddling
+ * chunk boundaries (and COBS frames, which must be decoded) are buffered.
+ * @note At most `maxFrameSize` bytes are ever buffered, larger frames are
+ * dropped and reported as `OVERSIZED`. For NDJSON the limit applies to the
+ * raw line, including a trailing `\r`.
+ * @note The parser has no dependency on ArduinoJson or FreeRTOS, so it can be
+ * built and fuzzed on the host, see test/test_frame_parser.
+ *
+ * @code
+ * ```
+ * Helpers::FrameParser parser(Helpers::FRAMING_NDJSON, 512);
+ * parser.feed(chunk, length, [](const char* frame, size_t frameLength) {
+ *     // frame is only valid for the duration of the callback
+ * });
+ * ```
+ */
+class FrameParser {
+   public:
+    enum Error_e : uint8_t {
+        OVERSIZED,
+        MALFORMED,
+    };
+
+   private:
+    MessageFraming_t framing;
+    size_t maxFrameSize;
+    std::vector<char> pending;
+    bool discarding = false;
+
+    //* Stream position of the current chunk and of the current frame
+    size_t position = 0;
+    size_t frameStart = 0;
+
+    //* Length prefix state
+    uint8_t header[4] = {0, 0, 0, 0};
+    size_t headerBytes = 0;
+    size_t bodyLength = 0;
+    size_t bodyRemaining = 0;
+
+    //* COBS state
+    size_t blockRemaining = 0;
+    bool pendingZero = false;
+
+    //* Statistics
+    size_t frameCount = 0;
+    size_t oversizedCount = 0;
+    size_t malformedCount = 0;
+
+    template <typename FrameHandler>
+    size_t deliver(const char* frame, size_t length, FrameHandler& onFrame) {
+        if (length == 0) {
+            return 0;
+        }
+        frameCount++;
+        onFrame(frame, length);
+        return 1;
+    }
+
+    template <typename ErrorHandler>
+    void drop(Error_e error, ErrorHandler& onError) {
+        pending.clear();
+        discarding = true;
+        if (error == OVERSIZED) {
+            oversizedCount++;
+        } else {
+            malformedCount++;
+        }
+        onError(error, frameStart);
+    }
+
+    template <typename FrameHandler, typename ErrorHandler>
+    size_t feedLines(const char* data, size_t length, FrameHandler& onFrame,
+                     ErrorHandler& onError) {
+        size_t delivered = 0;
+        size_t offset = 0;
+        while (offset < length) {
+            const char* start = data + offset;
+            size_t remaining = length - offset;
+            const char* newline =
+                static_cast<const char*>(std::memchr(start, '\n', remaining));
+            size_t span = newline ? newline - start : remaining;
+
+            if (!discarding) {
+                if (pending.size() + span > maxFrameSize) {
+                    drop(OVERSIZED, onError);
+                } else if (newline && pending.empty()) {
+                    // the whole line is in this chunk, no copy needed
+                    size_t frameLength = span;
+                    if (frameLength > 0 && start[frameLength - 1] == '\r') {
+                        frameLength--;
+                    }
+                    delivered += deliver(start, frameLength, onFrame);
+                } else {
+                    pending.insert(pending.end(), start, start + span);
+                    if (newline) {
+                        size_t frameLength = pending.size();
+                        if (frameLength > 0 &&
+                            pending[frameLength - 1] == '\r') {
+                            frameLength--;
+                        }
+                        delivered +=
+                            deliver(pending.data(), frameLength, onFrame);
+                        pending.clear();
+                    }
+                }
+            }
+
+            offset += span;
+            if (newline) {
+                offset++;
+                discarding = false;
+                frameStart = position + offset;
+            }
+        }
+        return delivered;
+    }
+
+    template <typename FrameHandler, typename ErrorHandler>
+    size_t feedLengthPrefixed(const char* data, size_t length,
+                              FrameHandler& onFrame, ErrorHandler& onError) {
+        size_t delivered = 0;
+        size_t offset = 0;
+        while (offset < length) {
+            if (headerBytes < 4) {
+                header[headerBytes++] = static_cast<uint8_t>(data[offset++]);
+                if (headerBytes < 4) {
+                    continue;
+                }
+                bodyLength = (static_cast<uint32_t>(header[0]) << 24) |
+                             (static_cast<uint32_t>(header[1]) << 16) |
+                             (static_cast<uint32_t>(header[2]) << 8) |
+                             static_cast<uint32_t>(header[3]);
+                bodyRemaining = bodyLength;
+                if (bodyLength > maxFrameSize) {
+                    drop(OVERSIZED, onError);
+                }
+            } else {
+                size_t take = std::min(bodyRemaining, length - offset);
+                if (!discarding) {
+                    if (pending.empty() && take == bodyLength) {
+                        // the whole body is in this chunk, no copy needed
+                        delivered += deliver(data + offset, take, onFrame);
+                    } else {
+                        pending.insert(pending.end(), data + offset,
+                                       data + offset + take);
+                    }
+                }
+                bodyRemaining -= take;
+                offset += take;
+            }
+
+            if (headerBytes == 4 && bodyRemaining == 0) {
+                if (!pending.empty()) {
+                    delivered +=
+                        deliver(pending.data(), pending.size(), onFrame);
+                    pending.clear();
+                }
+                headerBytes = 0;
+                discarding = false;
+                frameStart = position + offset;
+            }
+        }
+        return delivered;
+    }
+
+    template <typename FrameHandler, typename ErrorHandler>
+    size_t feedCobs(const char* data, size_t length, FrameHandler& onFrame,
+                    ErrorHandler& onError) {
+        size_t delivered = 0;
+        size_t offset = 0;
+        while (offset < length) {
+            uint8_t byte = static_cast<uint8_t>(data[offset]);
+
+            if (byte == 0) {
+                // frame delimiter
+                if (!discarding) {
+                    if (blockRemaining != 0) {
+                        drop(MALFORMED, onError);
+                    } else {
+                        delivered +=
+                            deliver(pending.data(), pending.size(), onFrame);
+                    }
+                }
+                pending.clear();
+                blockRemaining = 0;
+                pendingZero = false;
+                discarding = false;
+                offset++;
+                frameStart = position + offset;
+                continue;
+            }
+
+            if (blockRemaining == 0) {
+                // code byte, the zero implied by the previous block is only
+                // emitted once we know the frame continues
+                if (!discarding && pendingZero) {
+                    if (pending.size() + 1 > maxFrameSize) {
+                        drop(OVERSIZED, onError);
+                    } else {
+                        pending.push_back(0);
+                    }
+                }
+                blockRemaining = byte - 1;
+                pendingZero = byte != 0xFF;
+                offset++;
+                continue;
+            }
+
+            // copy the run of data bytes up to the end of the block or the
+            // next delimiter, whichever comes first
+            size_t run = std::min(blockRemaining, length - offset);
+            const char* zero =
+                static_cast<const char*>(std::memchr(data + offset, 0, run));
+            if (zero) {
+                run = zero - (data + offset);
+            }
+            if (!discarding) {
+                if (pending.size() + run > maxFrameSize) {
+                    drop(OVERSIZED, onError);
+                } else {
+                    pending.insert(pending.end(), data + offset,
+                                   data + offset + run);
+                }
+            }
+            blockRemaining -= run;
+            offset += run;
+        }
+        return delivered;
+    }
+
+   public:
+    /**
+     * @brief Construct a new Frame Parser
+     * @param framing How frames are delimited in the stream
+     * @param maxFrameSize The largest frame, in bytes, that will be buffered
+     */
+    FrameParser(MessageFraming_t framing, size_t maxFrameSize = 1024)
+        : framing(framing), maxFrameSize(maxFrameSize) {}
+
+    /**
+     * @brief Feed a chunk of the stream to the parser
+     * @param data The chunk
+     * @param length The size of the chunk in bytes
+     * @param onFrame Called as `onFrame(const char* frame, size_t length)` for
+     * every completed frame, the pointer is only valid during the call
+     * @param onError Called as `onError(Error_e error, size_t offset)` for
+     * every dropped frame, `offset` is the stream position of the frame
+     * @return size_t The number of frames delivered from this chunk
+     */
+    template <typename FrameHandler, typename ErrorHandler>
+    size_t feed(const char* data, size_t length, FrameHandler&& onFrame,
+                ErrorHandler&& onError) {
+        size_t delivered = 0;
+        switch (framing) {
+            case FRAMING_NDJSON:
+                delivered = feedLines(data, length, onFrame, onError);
+                break;
+            case FRAMING_LENGTH_PREFIXED:
+                delivered = feedLengthPrefixed(data, length, onFrame, onError);
+                break;
+            case FRAMING_COBS:
+                delivered = feedCobs(data, length, onFrame, onError);
+                break;
+        }
+        position += length;
+        return delivered;
+    }
+
+    /**
+     * @brief Feed a chunk of the stream to the parser, silently dropping bad
+     * frames
+     */
+    template <typename FrameHandler>
+    size_t feed(const char* data, size_t length, FrameHandler&& onFrame) {
+        return feed(data, length, onFrame, [](Error_e, size_t) {});
+    }
+
+    /**
+     * @brief Drop any partially received frame and reset the statistics
+     */
+    void reset() {
+        pending.clear();
+        discarding = false;
+        position = 0;
+        frameStart = 0;
+        headerBytes = 0;
+        bodyLength = 0;
+        bodyRemaining = 0;
+        blockRemaining = 0;
+        pendingZero = false;
+        frameCount = 0;
+        oversizedCount = 0;
+        malformedCount = 0;
+    }
+
+    /**
+     * @brief Stream position of the frame currently being delivered
+     * @note Only meaningful inside the `onFrame` callback
+     */
+    size_t frameOffset() const {
+        return frameStart;
+    }
+
+    MessageFraming_t getFraming() const {
+        return framing;
+    }
+
+    size_t getMaxFrameSize() const {
+        return maxFrameSize;
+    }
+
+    size_t buffered() const {
+        return pending.size();
+    }
+
+    size_t frames() const {
+        return frameCount;
+    }
+
+    size_t oversized() const {
+        return oversizedCount;
+    }
+
+    size_t malformed() const {
+        return malformedCount;
+    }
+};
+}  // namespace Helpers
@@ -35,6 +35,9 @@ void split(const std::string& str, const std::string& splitBy,
 std::vector<std::string> split(const std::string& s, char delimiter);
 // char* appendChartoChar(const char* hostname, const char* def_host);
 // char* StringtoChar(const std::string& inputString);
+/// @brief Draw a single progress bar on the current terminal line
+/// @note Prefer `ProgressRenderer` from progress.hpp for tight loops or
+/// several concurrent jobs
 void update_progress_bar(int progress, int total);
 
 /// @brief
@@ -0,0 +1,221 @@
+#pragma once
+#include <ArduinoJson.h>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace Helpers {
+
+/**
+ * @brief Numeric summary of the values selected by a `JsonQuery`
+ */
+struct JsonAggregate {
+    size_t count = 0;
+    double sum = 0;
+    double min = 0;
+    double max = 0;
+
+    double mean() const {
+        return count ? sum / count : 0;
+    }
+
+    void add(double value) {
+        min = count == 0 || value < min ? value : min;
+        max = count == 0 || value > max ? value : max;
+        sum += value;
+        count++;
+    }
+};
+
+/**
+ * @brief A path and predicate expression compiled once, then evaluated over
+ * messages without copying them
+ * @note Paths: `a.b`, `a[0]`, `a[*]` or `a.*` for every element or member,
+ * `a["odd key"]` or `['odd key']`, optionally starting with `$`. A wildcard
+ * matches if any of its elements does.
+ * @note Predicates: `path op literal` with `==`, `!=`, `<`, `<=`, `>`, `>=`
+ * against numbers, strings, `true`, `false` and `null`, combined with `&&`,
+ * `||`, `!` and parentheses. A bare path is true if it exists and is neither
+ * `null` nor `false`.
+ * @note All the paths of an expression share one trie, so each object is
+ * scanned once per message whatever the number of keys looked up in it.
+ * Keys are measured once at compile time and compared by length first.
+ * @note Results are views into the messages, valid until they change. A
+ * query keeps scratch space between messages, use it from one thread at a
+ * time.
+ *
+ * @code
+ * ```
+ * Helpers::JsonQuery hot("sensors[*].temp > 40");
+ * for (JsonVariantConst message : hot.filter(strategy->messages())) { ... }
+ *
+ * // the temperatures above 40, and their statistics
+ * auto temps = hot.project(strategy->messages());
+ * Helpers::JsonAggregate stats = hot.aggregate(strategy->messages());
+ * ```
+ */
+class JsonQuery {
+    enum Kind_e : uint8_t { OR, AND, NOT, COMPARE, EXISTS };
+    enum Op_e : uint8_t { EQ, NE, LT, LE, GT, GE };
+    enum Literal_e : uint8_t { NUMBER, STRING, BOOLEAN, NONE };
+
+    struct Literal {
+        Literal_e type = NONE;
+        double number = 0;
+        bool flag = false;
+        std::string text;
+    };
+
+    struct Node {
+        Kind_e kind = EXISTS;
+        Op_e op = EQ;
+        uint32_t left = 0;
+        uint32_t right = 0;
+        uint32_t path = 0;
+        Literal literal;
+    };
+
+    struct PathNode {
+        std::string key;
+        int32_t index = -1;
+        uint32_t wildcard = 0;
+        //* Child nodes looked up by key, then by index
+        std::vector<uint32_t> keys;
+        std::vector<uint32_t> indices;
+        //* Paths ending here
+        std::vector<uint32_t> paths;
+    };
+
+    class Parser;
+
+    std::vector<Node> nodes;
+    uint32_t root = 0;
+    //* Node 0 is the document root
+    std::vector<PathNode> trie;
+    //* The values each path resolved to in the current message
+    std::vector<std::vector<JsonVariantConst> > bindings;
+    std::string error;
+    size_t errorOffset = 0;
+
+    void bind(uint32_t node, JsonVariantConst value);
+    void resolve(JsonVariantConst message);
+    bool evaluate(uint32_t node) const;
+    static bool compare(JsonVariantConst value, Op_e op,
+                        const Literal& literal);
+    static bool truthy(JsonVariantConst value);
+    //* The selected values of a path or comparison query
+    void selected(std::vector<JsonVariantConst>& out) const;
+
+   public:
+    explicit JsonQuery(const std::string& expression);
+
+    /**
+     * @brief false if the expression did not compile
+     */
+    bool valid() const {
+        return error.empty();
+    }
+
+    const std::string& getError() const {
+        return error;
+    }
+
+    //* The position in the expression the error was found at
+    size_t getErrorOffset() const {
+        return errorOffset;
+    }
+
+    /**
+     * @brief Evaluate the predicate against one message
+     */
+    bool matches(JsonVariantConst message);
+
+    bool matches(const JsonDocument& message) {
+        return matches(message.as<JsonVariantConst>());
+    }
+
+    /**
+     * @brief Append the values the query selects in one message
+     * @note A path selects every value it reaches, a comparison the values
+     * that satisfy it. Queries combining several paths select nothing.
+     */
+    void select(JsonVariantConst message, std::vector<JsonVariantConst>& out);
+
+    void select(const JsonDocument& message,
+                std::vector<JsonVariantConst>& out) {
+        select(message.as<JsonVariantConst>(), out);
+    }
+
+    /**
+     * @brief The messages matching the predicate, in one pass
+     * @tparam Range Any range of `JsonDocument`, e.g.
+     * `MessageBuffer::messages()`
+     */
+    template <typename Range>
+    std::vector<JsonVariantConst> filter(const Range& messages) {
+        std::vector<JsonVariantConst> result;
+        for (const JsonDocument& message : messages) {
+            JsonVariantConst view = message.as<JsonVariantConst>();
+            if (matches(view)) {
+                result.push_back(view);
+            }
+        }
+        return result;
+    }
+
+    /**
+     * @brief The values selected in every message, in one pass
+     * @param where Only project the messages matching this query
+     */
+    template <typename Range>
+    std::vector<JsonVariantConst> project(const Range& messages,
+                                          JsonQuery* where = nullptr) {
+        std::vector<JsonVariantConst> result;
+        for (const JsonDocument& message : messages) {
+            JsonVariantConst view = message.as<JsonVariantConst>();
+            if (!where || where->matches(view)) {
+                select(view, result);
+            }
+        }
+        return result;
+    }
+
+    /**
+     * @brief Count, sum, min and max of the numeric values selected in
+     * every message, in one pass
+     * @param where Only aggregate the messages matching this query
+     */
+    template <typename Range>
+    JsonAggregate aggregate(const Range& messages, JsonQuery* where = nullptr) {
+        JsonAggregate result;
+        std::vector<JsonVariantConst> values;
+        for (const JsonDocument& message : messages) {
+            JsonVariantConst view = message.as<JsonVariantConst>();
+            if (where && !where->matches(view)) {
+                continue;
+            }
+            values.clear();
+            select(view, values);
+            for (JsonVariantConst value : values) {
+                if (value.is<double>()) {
+                    result.add(value.as<double>());
+                }
+            }
+        }
+        return result;
+    }
+
+    /**
+     * @brief The number of messages matching the predicate
+     */
+    template <typename Range>
+    size_t count(const Range& messages) {
+        size_t matching = 0;
+        for (const JsonDocument& message : messages) {
+            matching += matches(message.as<JsonVariantConst>());
+        }
+        return matching;
+    }
+};
+}  // namespace Helpers
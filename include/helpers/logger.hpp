@@ -1,17 +1,23 @@
 #pragma once
 #include <algorithm>
+#include <atomic>
 #include <fstream>
 #include <iostream>
 #include <sstream>
 #include <string>
+#include <string_view>
+#include "enum_reflection.hpp"
 #include "helpers.hpp"
 #include "id_interface.hpp"
+#include "memory_accounting.hpp"
 
 namespace Helpers {
 
 class LoggerID {
    protected:
     std::string label;
+    //* The "Logger" account of this label
+    EASYHELPERS_MEMORY_ACCOUNT_CACHE(labelMemory);
 
    public:
     LoggerID() = default;
@@ -19,12 +25,26 @@ class LoggerID {
 
     void setLabel(const std::string& label) {
         this->label = label;
+#if EASYHELPERS_MEMORY_ACCOUNTING
+        labelMemory.reset();
+#endif
     }
     std::string getLabel() const {
         return this->label;
     }
 };
 
+/**
+ * @brief Destination for formatted log records
+ * @note `write` may be called concurrently from several tasks
+ */
+class LogSink {
+   public:
+    virtual ~LogSink() = default;
+    virtual void write(uint8_t level, const char* message, size_t length) = 0;
+    virtual void flush() {}
+};
+
 class Logger : public LoggerID {
    public:
     enum LogLevel_e : uint8_t {
@@ -37,15 +57,7 @@ class Logger : public LoggerID {
     };
 
    protected:
-    std::string checkLogLevel(LogLevel_e log_level) {
-        static const std::array<std::string, NUM_LOG_LEVELS> logLevelStrings = {
-            "DEBUG", "INFO", "WARN", "ERROR", "FATAL"};
-
-        if (log_level >= 0 && log_level < NUM_LOG_LEVELS)
-            return logLevelStrings[log_level];
-
-        return "UNKNOWN";
-    }
+    std::string_view checkLogLevel(LogLevel_e log_level);
 
     template <typename... Args>
     std::string handleInput(Args... args) {
@@ -56,29 +68,70 @@ class Logger : public LoggerID {
         return message;
     }
 
+    void emit(LogLevel_e log_level, const std::string& logMessage) {
+        LogSink* current = sink.load(std::memory_order_acquire);
+        if (current) {
+            current->write(log_level, logMessage.data(), logMessage.size());
+            return;
+        }
+        std::cout << logMessage << '\n';
+    }
+
+    inline static std::atomic<LogSink*> sink{nullptr};
+
    public:
     Logger() = default;
     virtual ~Logger() = default;
 
+    /**
+     * @brief Route every logger to `sink` instead of `std::cout`
+     * @param sink The sink, `nullptr` restores `std::cout`
+     * @note The sink is shared by all loggers and is not owned, it must
+     * outlive any logging done through it
+     */
+    static void setSink(LogSink* sink) {
+        Logger::sink.store(sink, std::memory_order_release);
+    }
+
+    static LogSink* getSink() {
+        return sink.load(std::memory_order_acquire);
+    }
+
     // Templated log function to handle various data types and arguments
     template <typename... Args>
     void log(LogLevel_e log_level, Args... args) {
+        EASYHELPERS_MEMORY_SCOPE_CACHED(this->labelMemory, "Logger",
+                                        this->label);
         std::string message = handleInput(args...);
-        std::string logLevel = checkLogLevel(log_level);
-        std::string logMessage =
-            Helpers::format_string("[%s - %s]: %s", logLevel.c_str(),
-                                   this->getLabel().c_str(), message.c_str());
-        std::cout << logMessage << '\n';
+        std::string_view logLevel = checkLogLevel(log_level);
+        std::string logMessage = Helpers::format_string(
+            "[%.*s - %s]: %s", static_cast<int>(logLevel.size()),
+            logLevel.data(), this->getLabel().c_str(), message.c_str());
+        emit(log_level, logMessage);
     }
     template <typename... Args>
     void log(Args... args) {
+        EASYHELPERS_MEMORY_SCOPE_CACHED(this->labelMemory, "Logger",
+                                        this->label);
         std::string message = handleInput(args...);
-        std::string logLevel = checkLogLevel(LogLevel_e::INFO);
-        std::string logMessage =
-            Helpers::format_string("[%s - %s]: %s", logLevel.c_str(),
-                                   this->getLabel().c_str(), message.c_str());
-        std::cout << logMessage << '\n';
+        std::string_view logLevel = checkLogLevel(LogLevel_e::INFO);
+        std::string logMessage = Helpers::format_string(
+            "[%.*s - %s]: %s", static_cast<int>(logLevel.size()),
+            logLevel.data(), this->getLabel().c_str(), message.c_str());
+        emit(LogLevel_e::INFO, logMessage);
     }
 };
 using LogLevel_t = Logger::LogLevel_e;
 }  // namespace Helpers
+
+EASYHELPERS_REFLECT_ENUM(Helpers::Logger::LogLevel_e, DEBUG, INFO, WARN, ERROR,
+                         FATAL);
+
+namespace Helpers {
+inline std::string_view Logger::checkLogLevel(LogLevel_e log_level) {
+    std::string_view name = enumName(log_level);
+    if (name.empty())
+        return "UNKNOWN";
+    return name;
+}
+}  // namespace Helpers
@@ -0,0 +1,314 @@
+#pragma once
+#include <ArduinoJson.h>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <type_traits>
+#include <vector>
+#include "id_interface.hpp"
+
+/**
+ * @brief Attribute heap allocations to the subsystem and instance that made
+ * them
+ * @note Disabled by default, enable with the build flag
+ * `-DEASYHELPERS_MEMORY_ACCOUNTING=1` on every translation unit. This
+ * replaces the global `operator new`/`operator delete`, including the
+ * over-aligned forms, each block then carries a small header recording its
+ * size and account.
+ * @note `MessageBuffer` documents are allocated through
+ * `accountedJsonAllocator()`, as ArduinoJson uses `malloc` directly.
+ */
+#ifndef EASYHELPERS_MEMORY_ACCOUNTING
+#    define EASYHELPERS_MEMORY_ACCOUNTING 0
+#endif
+
+namespace Helpers {
+
+/**
+ * @brief Allocation counters of one subsystem or instance
+ * @note Accounts form a tree: instance, subsystem, total. Each allocation is
+ * charged to its account and every parent, so each level has its own peak.
+ */
+class MemoryAccount {
+    std::string subsystem;
+    std::string instance;
+    MemoryAccount* parent;
+    std::atomic<int64_t> currentBytes{0};
+    std::atomic<int64_t> peakBytes{0};
+    std::atomic<uint64_t> allocationCount{0};
+    std::atomic<uint64_t> deallocationCount{0};
+
+   public:
+    MemoryAccount(const std::string& subsystem, const std::string& instance,
+                  MemoryAccount* parent)
+        : subsystem(subsystem), instance(instance), parent(parent) {}
+
+    MemoryAccount(const MemoryAccount&) = delete;
+    MemoryAccount& operator=(const MemoryAccount&) = delete;
+
+    void allocated(size_t size) {
+        for (MemoryAccount* account = this; account;
+             account = account->parent) {
+            int64_t current = account->currentBytes.fetch_add(
+                                  size, std::memory_order_relaxed) +
+                              size;
+            int64_t peak = account->peakBytes.load(std::memory_order_relaxed);
+            while (current > peak &&
+                   !account->peakBytes.compare_exchange_weak(
+                       peak, current, std::memory_order_relaxed)) {
+            }
+            account->allocationCount.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+
+    void released(size_t size) {
+        for (MemoryAccount* account = this; account;
+             account = account->parent) {
+            account->currentBytes.fetch_sub(size, std::memory_order_relaxed);
+            account->deallocationCount.fetch_add(1,
+                                                 std::memory_order_relaxed);
+        }
+    }
+
+    void resetPeak() {
+        peakBytes.store(currentBytes.load(std::memory_order_relaxed),
+                        std::memory_order_relaxed);
+    }
+
+    const std::string& getSubsystem() const {
+        return subsystem;
+    }
+
+    const std::string& getInstance() const {
+        return instance;
+    }
+
+    MemoryAccount* getParent() const {
+        return parent;
+    }
+
+    int64_t getCurrentBytes() const {
+        return currentBytes.load(std::memory_order_relaxed);
+    }
+
+    int64_t getPeakBytes() const {
+        return peakBytes.load(std::memory_order_relaxed);
+    }
+
+    uint64_t getAllocations() const {
+        return allocationCount.load(std::memory_order_relaxed);
+    }
+
+    uint64_t getDeallocations() const {
+        return deallocationCount.load(std::memory_order_relaxed);
+    }
+};
+
+/**
+ * @brief A point in time copy of an account
+ * @note `instance` is empty for subsystem totals, both are empty for the
+ * grand total
+ */
+struct MemoryUsage {
+    std::string subsystem;
+    std::string instance;
+    int64_t currentBytes;
+    int64_t peakBytes;
+    uint64_t allocations;
+    uint64_t deallocations;
+};
+
+/**
+ * @brief Every allocation, attributed or not
+ */
+MemoryAccount& memoryTotal();
+
+/**
+ * @brief The account of a subsystem, e.g. "MessageBuffer"
+ */
+MemoryAccount& memoryAccount(const std::string& subsystem);
+
+/**
+ * @brief The account of one instance of a subsystem
+ * @param instance The instance's label or `IId`
+ */
+MemoryAccount& memoryAccount(const std::string& subsystem,
+                             const std::string& instance);
+
+/**
+ * @brief Name an instance by its `IId` if it has one, its address otherwise
+ */
+std::string memoryInstance(const void* self, const IId* id);
+
+template <typename T>
+std::string memoryInstance(const T* self) {
+    if constexpr (std::is_polymorphic<T>::value) {
+        return memoryInstance(self, dynamic_cast<const IId*>(self));
+    } else {
+        return memoryInstance(self, nullptr);
+    }
+}
+
+/**
+ * @brief Snapshot every account: the total, then each subsystem followed by
+ * its instances
+ */
+std::vector<MemoryUsage> memoryUsage();
+
+/**
+ * @brief Write every account into `doc`
+ * @code
+ * ```
+ * {"current": 2048, "peak": 4096, "allocations": 12, "deallocations": 4,
+ *  "subsystems": {"MessageBuffer": {"current": ..., "instances": {"3": {...}}}}}
+ * ```
+ */
+void memoryUsageJson(JsonDocument& doc);
+
+/**
+ * @brief Restart every peak from the current usage
+ */
+void resetMemoryPeaks();
+
+//* Allocate, free and resize blocks charged to the current scope's account
+void* accountedAllocate(size_t size);
+void accountedFree(void* block);
+void* accountedReallocate(void* block, size_t size);
+
+//* Blocks aligned beyond `alignof(std::max_align_t)`, freed with
+//* `accountedFreeAligned`
+void* accountedAllocateAligned(size_t size, size_t alignment);
+void accountedFreeAligned(void* block);
+
+/**
+ * @brief ArduinoJson allocator charging documents to the current scope
+ */
+ArduinoJson::Allocator* accountedJsonAllocator();
+
+/**
+ * @brief Charge the allocations made on this thread, while the scope lives,
+ * to an account
+ * @note Scopes nest, the innermost one wins. Memory is credited back to the
+ * account it was charged to, wherever it is freed.
+ * @note Allocations outside of any scope are charged to "Unattributed".
+ */
+class MemoryScope {
+    MemoryAccount* previous;
+
+   public:
+    explicit MemoryScope(MemoryAccount& account);
+
+    /**
+     * @note Looks the account up in the registry on every construction, owners
+     * entering scopes often keep a `MemoryAccountCache` instead
+     */
+    MemoryScope(const std::string& subsystem, const std::string& instance)
+        : MemoryScope(memoryAccount(subsystem, instance)) {}
+
+    MemoryScope(const std::string& subsystem, const char* instance)
+        : MemoryScope(memoryAccount(subsystem, instance)) {}
+
+    template <typename T>
+    MemoryScope(const std::string& subsystem, const T* self)
+        : MemoryScope(memoryAccount(subsystem, memoryInstance(self))) {}
+
+    ~MemoryScope();
+
+    MemoryScope(const MemoryScope&) = delete;
+    MemoryScope& operator=(const MemoryScope&) = delete;
+
+    /**
+     * @brief The account charged on this thread, `nullptr` outside of scopes
+     */
+    static MemoryAccount* current();
+};
+
+/**
+ * @brief The account of an owner, looked up once and then reused by the
+ * scopes opened on its behalf
+ * @note Declared with `EASYHELPERS_MEMORY_ACCOUNT_CACHE`, which compiles it
+ * out unless accounting is enabled. A copy starts empty, it belongs to
+ * another instance.
+ * @note The instance is named on the first `get`, an owner renamed later,
+ * e.g. by `setID`, keeps charging that account until `reset`.
+ */
+class MemoryAccountCache {
+    std::atomic<MemoryAccount*> account{nullptr};
+
+    static MemoryAccount& find(const char* subsystem,
+                               const std::string& instance) {
+        return memoryAccount(subsystem, instance);
+    }
+
+    static MemoryAccount& find(const char* subsystem, const char* instance) {
+        return memoryAccount(subsystem, instance);
+    }
+
+    template <typename T>
+    static MemoryAccount& find(const char* subsystem, const T* self) {
+        return memoryAccount(subsystem, memoryInstance(self));
+    }
+
+   public:
+    MemoryAccountCache() = default;
+    MemoryAccountCache(const MemoryAccountCache&) {}
+    MemoryAccountCache& operator=(const MemoryAccountCache&) {
+        return *this;
+    }
+
+    /**
+     * @brief The account of `instance` in `subsystem`, from the registry on
+     * the first call only
+     * @param instance The instance label, or a pointer to the instance
+     */
+    template <typename Instance>
+    MemoryAccount& get(const char* subsystem, const Instance& instance) {
+        MemoryAccount* cached = account.load(std::memory_order_acquire);
+        if (!cached) {
+            // racing lookups find the same account
+            cached = &find(subsystem, instance);
+            account.store(cached, std::memory_order_release);
+        }
+        return *cached;
+    }
+
+    //* Look the account up again on the next `get`, e.g. after a rename
+    void reset() {
+        account.store(nullptr, std::memory_order_release);
+    }
+};
+}  // namespace Helpers
+
+#define EASYHELPERS_MEMORY_CAT_(a, b) a##b
+#define EASYHELPERS_MEMORY_CAT(a, b) EASYHELPERS_MEMORY_CAT_(a, b)
+
+/**
+ * @brief Open a `MemoryScope` until the end of the block, compiled out unless
+ * `EASYHELPERS_MEMORY_ACCOUNTING` is enabled
+ * @param subsystem The subsystem name
+ * @param instance The instance label, or a pointer to the instance
+ * @note `EASYHELPERS_MEMORY_SCOPE_CACHED(cache, subsystem, instance)` does the
+ * same through a member declared with
+ * `EASYHELPERS_MEMORY_ACCOUNT_CACHE(cache)`, for scopes opened on every call
+ * of an owner's methods
+ */
+#if EASYHELPERS_MEMORY_ACCOUNTING
+#    define EASYHELPERS_MEMORY_SCOPE(subsystem, instance) \
+        Helpers::MemoryScope EASYHELPERS_MEMORY_CAT(      \
+            memoryScope, __LINE__)(subsystem, instance)
+#    define EASYHELPERS_MEMORY_ACCOUNT_CACHE(name) \
+        Helpers::MemoryAccountCache name
+#    define EASYHELPERS_MEMORY_SCOPE_CACHED(cache, subsystem, instance) \
+        Helpers::MemoryScope EASYHELPERS_MEMORY_CAT(                    \
+            memoryScope, __LINE__)((cache).get(subsystem, instance))
+#else
+#    define EASYHELPERS_MEMORY_SCOPE(subsystem, instance) \
+        do {                                              \
+        } while (0)
+#    define EASYHELPERS_MEMORY_ACCOUNT_CACHE(name) \
+        static_assert(true, "memory accounting is disabled")
+#    define EASYHELPERS_MEMORY_SCOPE_CACHED(cache, subsystem, instance) \
+        do {                                                            \
+        } while (0)
+#endif
@@ -0,0 +1,212 @@
+#pragma once
+#include <ArduinoJson.h>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <deque>
+#include <functional>
+#include <string>
+#include <vector>
+#include "freertos/semphr.h"
+#include "frame_parser.hpp"
+#include "message_buffer.hpp"
+
+namespace Helpers {
+
+/**
+ * @brief Destination of the batches flushed by a `MessageBatcher`
+ * @param data The framed messages of the batch, only valid for the call
+ * @param messages The number of messages in the batch
+ * @return false if the batch could not be delivered, it is counted as failed
+ */
+class BatchSink {
+   public:
+    virtual ~BatchSink() = default;
+    virtual bool write(const uint8_t* data, size_t length,
+                       size_t messages) = 0;
+};
+
+/**
+ * @brief Feeds batches back into a `MessageBuffer`, e.g. to exercise a
+ * strategy's outbound path against its own inbound one
+ */
+template <typename EnumT>
+class LoopbackSink : public BatchSink {
+    MessageBuffer<EnumT>& target;
+    MessageFraming_t framing;
+
+   public:
+    LoopbackSink(MessageBuffer<EnumT>& target,
+                 MessageFraming_t framing = FRAMING_NDJSON)
+        : target(target), framing(framing) {}
+
+    bool write(const uint8_t* data, size_t length, size_t) override {
+        return target
+            .deserializeBatch(reinterpret_cast<const char*>(data), length,
+                              framing)
+            .ok();
+    }
+};
+
+/**
+ * @brief Appends batches to a file, one `fwrite` per batch
+ */
+class FileSink : public BatchSink {
+    FILE* file;
+
+   public:
+    explicit FileSink(const std::string& path, bool append = true);
+    ~FileSink();
+    FileSink(const FileSink&) = delete;
+    FileSink& operator=(const FileSink&) = delete;
+
+    bool good() const {
+        return file != nullptr;
+    }
+
+    bool write(const uint8_t* data, size_t length, size_t messages) override;
+};
+
+/**
+ * @brief When a `MessageBatcher` hands its batch to the sink
+ * @param maxBytes Flush before a message would grow the batch past this
+ * size, a larger message is sent on its own
+ * @param maxMessages Flush once the batch holds this many messages
+ * @param lingerMs Flush from `poll` once the oldest message has waited this
+ * long, 0 flushes on every `poll`. `add` never flushes on the linger, so even
+ * with 0 the messages added between two polls share a batch
+ * @param framing How the messages are delimited in a batch, as expected by
+ * `MessageBuffer::deserializeBatch` on the receiving side
+ */
+struct BatchConfig {
+    size_t maxBytes = 1024;
+    size_t maxMessages = 16;
+    uint32_t lingerMs = 10;
+    MessageFraming_t framing = FRAMING_NDJSON;
+};
+
+/**
+ * @brief Counters of a `MessageBatcher`, `bytes` include the framing
+ */
+struct BatchStats {
+    uint64_t messages = 0;
+    uint64_t batches = 0;
+    uint64_t bytes = 0;
+    uint64_t failed = 0;
+    //* Why each batch was flushed
+    uint64_t bySize = 0;
+    uint64_t byCount = 0;
+    uint64_t byLinger = 0;
+    uint64_t byRequest = 0;
+    size_t largestBatch = 0;
+
+    double messagesPerBatch() const {
+        return batches ? static_cast<double>(messages) / batches : 0;
+    }
+
+    double bytesPerBatch() const {
+        return batches ? static_cast<double>(bytes) / batches : 0;
+    }
+};
+
+/**
+ * @brief Accumulates outbound messages and hands them to a sink in batches
+ * @note Each message is serialized once, straight into a buffer that is
+ * reused across batches, so a flush is a single sink write with no copy.
+ * @note The batch is flushed when adding a message reaches the size or count
+ * threshold of `BatchConfig`, or from `poll` once the linger has expired. Call `poll`
+ * from the loop, `CustomEventManager::handleStrategies` does so for
+ * `BatchedEvent` strategies.
+ * @note The sink is called with the batcher unlocked, so it may add to the
+ * same batcher, e.g. an observer of a `LoopbackSink` answering with
+ * `sendMessage`. Batches are still written in order, one at a time: a batch
+ * sealed while another thread is writing is written by that thread.
+ * @note Pending messages are not flushed on destruction, call `flush`.
+ *
+ * @code
+ * ```
+ * Helpers::FileSink sink("/tmp/outbound.ndjson");
+ * Helpers::MessageBatcher batcher(sink, {4096, 64, 20});
+ * batcher.add(doc);
+ * // in loop()
+ * batcher.poll();
+ * ```
+ */
+class MessageBatcher {
+   public:
+    //* Returns milliseconds
+    using Clock_t = std::function<uint64_t()>;
+
+    enum FlushReason_e : uint8_t {
+        SIZE,
+        COUNT,
+        LINGER,
+        REQUEST,
+    };
+
+   private:
+    SemaphoreHandle_t mutex;
+    BatchSink* sink;
+    BatchConfig config;
+    Clock_t clock;
+
+    struct Batch {
+        std::string data;
+        size_t messages = 0;
+    };
+
+    //* Buffers kept for reuse once their batch has been written
+    static constexpr size_t MAX_SPARES = 2;
+
+    std::string buffer;
+    //* COBS messages are serialized here, then encoded into the buffer
+    std::string scratch;
+    size_t pending = 0;
+    uint64_t oldest = 0;
+    //* Sealed batches waiting for the sink, in order
+    std::deque<Batch> ready;
+    std::vector<std::string> spares;
+    bool delivering = false;
+    BatchStats stats;
+
+    static uint64_t steadyMillis();
+
+    //* Serialize and frame one message at the end of the buffer
+    void append(const JsonDocument& message);
+    //* Move the first `length` bytes, holding `messages`, to `ready`
+    void seal(size_t length, size_t messages, FlushReason_e reason);
+    //* Write the ready batches, with the mutex released around the sink
+    void deliver();
+
+   public:
+    MessageBatcher(BatchSink& sink, BatchConfig config = BatchConfig(),
+                   Clock_t clock = steadyMillis);
+    ~MessageBatcher();
+    MessageBatcher(const MessageBatcher&) = delete;
+    MessageBatcher& operator=(const MessageBatcher&) = delete;
+
+    /**
+     * @brief Queue a message, flushing if it reaches a threshold
+     */
+    void add(const JsonDocument& message);
+
+    /**
+     * @brief Flush the batch if its linger has expired
+     * @return true if a batch was flushed
+     */
+    bool poll();
+
+    /**
+     * @brief Flush the pending messages now
+     * @return true if there was anything to flush
+     */
+    bool flush();
+
+    void setSink(BatchSink& sink);
+
+    //* The number of messages waiting for the next flush
+    size_t size();
+    BatchStats getStats();
+    void resetStats();
+};
+}  // namespace Helpers
@@ -1,15 +1,130 @@
 #pragma once
 #include <ArduinoJson.h>
+#include <cstdint>
+#include <cstring>
 #include <optional>
 #include <string>
+#include <type_traits>
+#include <vector>
+#include "event_recorder.hpp"
+#include "frame_parser.hpp"
 #include "iter_queue.hpp"
+#include "memory_accounting.hpp"
+#include "message_schema.hpp"
 #include "observer.hpp"
 
 namespace Helpers {
 
+/**
+ * @brief A frame of a batch or stream that could not be parsed
+ * @param index The position of the frame in the batch
+ * @param offset The byte offset of the frame in the input or stream
+ * @param error The reason the frame was rejected
+ */
+struct FrameError {
+    size_t index;
+    size_t offset;
+    DeserializationError error;
+};
+
+/**
+ * @brief Outcome of `MessageBuffer::deserializeBatch` and
+ * `MessageBuffer::deserializeChunk`
+ * @param count The number of documents pushed into the buffer
+ * @param errors The frames that were skipped, in input order
+ */
+struct BatchResult {
+    size_t count = 0;
+    std::vector<FrameError> errors;
+
+    bool ok() const {
+        return errors.empty();
+    }
+};
+
 template <typename EnumT>
 class MessageBuffer : public ISubject<EnumT> {
     iter_queue<JsonDocument> buffer;
+    EASYHELPERS_MEMORY_ACCOUNT_CACHE(bufferMemory);
+
+    template <typename T, typename = void>
+    struct HasText : std::false_type {};
+
+    template <typename T>
+    struct HasText<T, std::void_t<decltype(std::declval<const T&>().c_str()),
+                                  decltype(std::declval<const T&>().length())> >
+        : std::true_type {};
+
+    template <typename T, typename = void>
+    struct HasNewMessage : std::false_type {};
+
+    template <typename T>
+    struct HasNewMessage<T, std::void_t<decltype(T::NewMessage)> >
+        : std::true_type {};
+
+    //* The event notified for new messages, `EnumT::NewMessage`, or
+    //* `EnumT::NEW_MESSAGE` for enums that only declare that one
+    template <typename T = EnumT>
+    static constexpr T newMessageEvent() {
+        if constexpr (HasNewMessage<T>::value) {
+            return T::NewMessage;
+        } else {
+            return T::NEW_MESSAGE;
+        }
+    }
+
+    //* Record a call when an `EventRecorder` is active
+    void recordCall(EventRecorder::RecordType_e type, const char* data,
+                    size_t length, uint64_t key = 0, int64_t event = 0) {
+        if (auto recorder = EventRecorder::active()) {
+            recorder->record(type, EventRecorder::subjectID(this), key, event,
+                             data, length);
+        }
+    }
+
+    void recordDocument(EventRecorder::RecordType_e type,
+                        const JsonDocument& doc) {
+        if (EventRecorder::active()) {
+            std::string json;
+            serializeJson(doc, json);
+            recordCall(type, json.data(), json.size());
+        }
+    }
+
+    //* Documents allocated from the accounted allocator when memory
+    //* accounting is enabled, see `EASYHELPERS_MEMORY_ACCOUNTING`
+    static JsonDocument newDocument() {
+#if EASYHELPERS_MEMORY_ACCOUNTING
+        return JsonDocument(accountedJsonAllocator());
+#else
+        return JsonDocument();
+#endif
+    }
+
+    // documents built elsewhere use ArduinoJson's allocator, copy them into
+    // an accounted one
+    static JsonDocument ownDocument(const JsonDocument& message) {
+#if EASYHELPERS_MEMORY_ACCOUNTING
+        JsonDocument doc = newDocument();
+        doc.set(message);
+        return doc;
+#else
+        return message;
+#endif
+    }
+
+    void pushFrame(const char* frame, size_t length, size_t index,
+                   size_t offset, BatchResult& result) {
+        EASYHELPERS_MEMORY_SCOPE_CACHED(bufferMemory, "MessageBuffer", this);
+        JsonDocument doc = newDocument();
+        DeserializationError err = deserializeJson(doc, frame, length);
+        if (err) {
+            result.errors.push_back({index, offset, err});
+            return;
+        }
+        buffer.push(std::move(doc));
+        result.count++;
+    }
 
    public:
     MessageBuffer() : buffer() {}
@@ -27,8 +142,11 @@ class MessageBuffer : public ISubject<EnumT> {
     }
 
     void addMessage(const JsonDocument& message) {
-        buffer.push(message);
-        this->notifyAll(EnumT::NEW_MESSAGE);
+        EASYHELPERS_MEMORY_SCOPE_CACHED(bufferMemory, "MessageBuffer", this);
+        recordDocument(EventRecorder::ADD_MESSAGE, message);
+        EventRecorder::Suppress suppress;
+        buffer.push(ownDocument(message));
+        this->notifyAll(newMessageEvent());
     }
 
     /**
@@ -88,6 +206,15 @@ class MessageBuffer : public ISubject<EnumT> {
         return std::nullopt;  // Key not found in any document
     }
 
+    /**
+     * @brief The buffered messages, to iterate in place, oldest first
+     * @note Iterators and references are invalidated by any change to the
+     * buffer
+     */
+    const iter_queue<JsonDocument>& messages() const {
+        return buffer;
+    }
+
     MessageBuffer& getInstance() {
         return *this;
     }
@@ -138,19 +265,198 @@ class MessageBuffer : public ISubject<EnumT> {
 
     template <typename T>
     std::optional<DeserializationError> deserialize(const T& data) {
-        JsonDocument doc;
+        EASYHELPERS_MEMORY_SCOPE_CACHED(bufferMemory, "MessageBuffer", this);
+        // text inputs are recorded as is, failures included. Streams can't be
+        // read twice, their document is recorded once parsed
+        if constexpr (std::is_convertible<const T&, const char*>::value) {
+            const char* text = data;
+            recordCall(EventRecorder::DESERIALIZE, text,
+                       text ? std::strlen(text) : 0);
+        } else if constexpr (HasText<T>::value) {
+            recordCall(EventRecorder::DESERIALIZE, data.c_str(), data.length());
+        }
+        JsonDocument doc = newDocument();
         DeserializationError err = deserializeJson(doc, data);
         if (err) {
             // return the error object if deserialization fails
             return err;
         }
-
-        buffer.push(doc);
-        this->notifyAll(EnumT::NewMessage);  // Notify observers on successful
-                                       // deserialization
+        if constexpr (!std::is_convertible<const T&, const char*>::value &&
+                      !HasText<T>::value) {
+            recordDocument(EventRecorder::DESERIALIZE, doc);
+        }
+        EventRecorder::Suppress suppress;
+        buffer.push(std::move(doc));
+        // Notify observers on successful deserialization
+        this->notifyAll(newMessageEvent());
 
         // return an empty optional if deserialization is successful
         return std::nullopt;
     }
+
+    /**
+     * @brief Decode a schema encoded message and push it as a `JsonDocument`
+     * @tparam T The message struct, see `EASYHELPERS_MESSAGE_SCHEMA`
+     * @return std::optional<DeserializationError> `InvalidInput` if the
+     * message could not be decoded
+     */
+    template <typename T>
+    std::optional<DeserializationError> deserializeBinary(const uint8_t* data,
+                                                          size_t length) {
+        EASYHELPERS_MEMORY_SCOPE_CACHED(bufferMemory, "MessageBuffer", this);
+        T message;
+        if (!decodeMessage(data, length, message)) {
+            return DeserializationError(DeserializationError::InvalidInput);
+        }
+        JsonDocument doc = toJsonDocument(message);
+        // replayed as the document it decoded to, the replayer does not know
+        // the schema
+        recordDocument(EventRecorder::ADD_MESSAGE, doc);
+        EventRecorder::Suppress suppress;
+        buffer.push(ownDocument(doc));
+        this->notifyAll(newMessageEvent());
+        return std::nullopt;
+    }
+
+    /**
+     * @brief Pop the message at the front of the queue as a schema struct
+     * @tparam T The message struct, see `EASYHELPERS_MESSAGE_SCHEMA`
+     * @note The message is removed even if it does not match the schema
+     */
+    template <typename T>
+    std::optional<T> getMessageAs() {
+        if (buffer.empty())
+            return std::nullopt;
+        T message;
+        bool matches = fromJsonDocument(buffer.front(), message);
+        buffer.pop();
+        if (!matches)
+            return std::nullopt;
+        return message;
+    }
+
+    /**
+     * @brief Deserialize every frame of a batch into the buffer
+     * @param data The framed input
+     * @param length The size of the input in bytes
+     * @param framing How the documents are delimited
+     * @return BatchResult The number of documents pushed and the frames that
+     * failed to parse
+     * @note Frames are parsed in place, a bad frame is reported and skipped
+     * without aborting the rest of the batch
+     * @note COBS frames have to be decoded before parsing, so they go through
+     * a `FrameParser` sized to the whole batch
+     * @note Observers are notified once for the whole batch, and only if at
+     * least one document was pushed
+     */
+    BatchResult deserializeBatch(const char* data, size_t length,
+                                 MessageFraming_t framing = FRAMING_NDJSON) {
+        recordCall(EventRecorder::BATCH, data, length, framing);
+        EventRecorder::Suppress suppress;
+        if (framing == FRAMING_COBS) {
+            FrameParser parser(framing, length);
+            return deserializeChunk(parser, data, length);
+        }
+
+        BatchResult result;
+        size_t index = 0;
+        size_t offset = 0;
+
+        while (offset < length) {
+            const char* frame = data + offset;
+            size_t remaining = length - offset;
+
+            if (framing == FRAMING_LENGTH_PREFIXED) {
+                if (remaining < 4) {
+                    result.errors.push_back(
+                        {index, offset, DeserializationError::IncompleteInput});
+                    break;
+                }
+                const uint8_t* header = reinterpret_cast<const uint8_t*>(frame);
+                size_t frameLength = (static_cast<uint32_t>(header[0]) << 24) |
+                                     (static_cast<uint32_t>(header[1]) << 16) |
+                                     (static_cast<uint32_t>(header[2]) << 8) |
+                                     static_cast<uint32_t>(header[3]);
+                if (frameLength > remaining - 4) {
+                    // a truncated frame poisons everything after it
+                    result.errors.push_back(
+                        {index, offset, DeserializationError::IncompleteInput});
+                    break;
+                }
+                pushFrame(frame + 4, frameLength, index++, offset, result);
+                offset += 4 + frameLength;
+                continue;
+            }
+
+            const char* newline =
+                static_cast<const char*>(std::memchr(frame, '\n', remaining));
+            size_t lineLength = newline ? newline - frame : remaining;
+            size_t frameLength = lineLength;
+            if (frameLength > 0 && frame[frameLength - 1] == '\r') {
+                frameLength--;
+            }
+            if (frameLength > 0) {
+                pushFrame(frame, frameLength, index++, offset, result);
+            }
+            offset += newline ? lineLength + 1 : lineLength;
+        }
+
+        if (result.count > 0) {
+            this->notifyAll(newMessageEvent());
+        }
+        return result;
+    }
+
+    /**
+     * @brief Deserialize every frame of a batch into the buffer
+     * @tparam T A string type exposing `c_str()` and `length()`, such as
+     * `std::string` or `String`
+     */
+    template <typename T>
+    BatchResult deserializeBatch(const T& data,
+                                 MessageFraming_t framing = FRAMING_NDJSON) {
+        return deserializeBatch(data.c_str(), data.length(), framing);
+    }
+
+    /**
+     * @brief Feed a chunk of a stream through a framing parser and deserialize
+     * every frame it completes
+     * @param parser The parser holding the stream state between chunks
+     * @param chunk The bytes received, split at any position
+     * @param length The size of the chunk in bytes
+     * @return BatchResult The number of documents pushed and the frames that
+     * were dropped or failed to parse
+     * @note Completed frames are parsed straight out of the chunk or the
+     * parser's buffer, no intermediate string is built
+     * @note Observers are notified once per chunk, and only if at least one
+     * document was pushed
+     */
+    BatchResult deserializeChunk(FrameParser& parser, const char* chunk,
+                                 size_t length) {
+        recordCall(EventRecorder::CHUNK, chunk, length, parser.getFraming(),
+                   parser.getMaxFrameSize());
+        EventRecorder::Suppress suppress;
+        BatchResult result;
+        size_t index = 0;
+
+        parser.feed(
+            chunk, length,
+            [&](const char* frame, size_t frameLength) {
+                pushFrame(frame, frameLength, index++, parser.frameOffset(),
+                          result);
+            },
+            [&](FrameParser::Error_e error, size_t offset) {
+                result.errors.push_back(
+                    {index++, offset,
+                     error == FrameParser::OVERSIZED
+                         ? DeserializationError::NoMemory
+                         : DeserializationError::InvalidInput});
+            });
+
+        if (result.count > 0) {
+            this->notifyAll(newMessageEvent());
+        }
+        return result;
+    }
 };
 }  // namespace Helpers
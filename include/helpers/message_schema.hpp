@@ -0,0 +1,620 @@
+#pragma once
+#include <ArduinoJson.h>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <optional>
+#include <string>
+#include <tuple>
+#include <type_traits>
+#include <vector>
+
+namespace Helpers {
+
+/**
+ * @brief Compile-time description of a message struct
+ * @tparam T The message struct
+ * @note Specialize with `EASYHELPERS_MESSAGE_SCHEMA` rather than by hand
+ */
+template <typename T>
+struct MessageSchema {
+    static constexpr bool defined = false;
+};
+
+template <typename T, typename M>
+struct SchemaField {
+    const char* name;
+    M T::*member;
+};
+
+template <typename T, typename M>
+constexpr SchemaField<T, M> schemaField(const char* name, M T::*member) {
+    return {name, member};
+}
+
+/**
+ * @brief Appends the binary encoding of a message to a byte vector
+ */
+class SchemaWriter {
+    std::vector<uint8_t>& out;
+
+   public:
+    explicit SchemaWriter(std::vector<uint8_t>& out) : out(out) {}
+
+    void byte(uint8_t value) {
+        out.push_back(value);
+    }
+
+    void bytes(const void* data, size_t length) {
+        const uint8_t* begin = static_cast<const uint8_t*>(data);
+        out.insert(out.end(), begin, begin + length);
+    }
+
+    //* LEB128, 7 bits per byte, small values take a single byte
+    void varint(uint64_t value) {
+        while (value >= 0x80) {
+            out.push_back(static_cast<uint8_t>(value | 0x80));
+            value >>= 7;
+        }
+        out.push_back(static_cast<uint8_t>(value));
+    }
+
+    //* Fixed width, little endian
+    template <typename U>
+    void fixed(U value) {
+        for (size_t i = 0; i < sizeof(U); i++) {
+            out.push_back(static_cast<uint8_t>(value >> (8 * i)));
+        }
+    }
+};
+
+/**
+ * @brief Reads a binary encoded message, every read is bounds checked
+ */
+class SchemaReader {
+    const uint8_t* data;
+    size_t length;
+    size_t offset = 0;
+
+   public:
+    SchemaReader(const uint8_t* data, size_t length)
+        : data(data), length(length) {}
+
+    size_t remaining() const {
+        return length - offset;
+    }
+
+    bool byte(uint8_t& value) {
+        if (offset >= length) {
+            return false;
+        }
+        value = data[offset++];
+        return true;
+    }
+
+    bool bytes(void* destination, size_t count) {
+        if (count > remaining()) {
+            return false;
+        }
+        std::memcpy(destination, data + offset, count);
+        offset += count;
+        return true;
+    }
+
+    bool varint(uint64_t& value) {
+        value = 0;
+        for (uint32_t shift = 0; shift < 64; shift += 7) {
+            uint8_t next;
+            if (!byte(next)) {
+                return false;
+            }
+            value |= static_cast<uint64_t>(next & 0x7f) << shift;
+            if (!(next & 0x80)) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    template <typename U>
+    bool fixed(U& value) {
+        if (sizeof(U) > remaining()) {
+            return false;
+        }
+        value = 0;
+        for (size_t i = 0; i < sizeof(U); i++) {
+            value |= static_cast<U>(data[offset++]) << (8 * i);
+        }
+        return true;
+    }
+};
+
+/**
+ * @brief Binary and JSON conversion of one field type
+ * @note Supported are booleans, integers, floating point numbers, enums,
+ * `std::string`, `std::vector`, `std::array`, `std::optional` and structs with
+ * a `MessageSchema`. Specialize it to add more.
+ */
+template <typename T, typename Enable = void>
+struct SchemaCodec;
+
+template <>
+struct SchemaCodec<bool> {
+    static void encode(SchemaWriter& writer, bool value) {
+        writer.byte(value ? 1 : 0);
+    }
+    static bool decode(SchemaReader& reader, bool& value) {
+        uint8_t byte;
+        if (!reader.byte(byte) || byte > 1) {
+            return false;
+        }
+        value = byte == 1;
+        return true;
+    }
+    static void toJson(JsonVariant json, bool value) {
+        json.set(value);
+    }
+    static bool fromJson(JsonVariantConst json, bool& value) {
+        if (!json.is<bool>()) {
+            return false;
+        }
+        value = json.as<bool>();
+        return true;
+    }
+};
+
+//* Single bytes are stored as is, wider integers as varints, signed ones
+//* zigzag encoded so that small negative values stay small
+template <typename T>
+struct SchemaCodec<
+    T, typename std::enable_if<std::is_integral<T>::value &&
+                               !std::is_same<T, bool>::value>::type> {
+    static void encode(SchemaWriter& writer, T value) {
+        if constexpr (sizeof(T) == 1) {
+            writer.byte(static_cast<uint8_t>(value));
+        } else if constexpr (std::is_signed<T>::value) {
+            uint64_t wide = static_cast<uint64_t>(int64_t(value));
+            writer.varint((wide << 1) ^ (value < 0 ? ~uint64_t(0) : 0));
+        } else {
+            writer.varint(value);
+        }
+    }
+    static bool decode(SchemaReader& reader, T& value) {
+        if constexpr (sizeof(T) == 1) {
+            uint8_t byte;
+            if (!reader.byte(byte)) {
+                return false;
+            }
+            value = static_cast<T>(byte);
+            return true;
+        } else {
+            uint64_t wide;
+            if (!reader.varint(wide)) {
+                return false;
+            }
+            if constexpr (std::is_signed<T>::value) {
+                int64_t decoded = static_cast<int64_t>(wide >> 1) ^
+                                  -static_cast<int64_t>(wide & 1);
+                value = static_cast<T>(decoded);
+                return decoded == static_cast<int64_t>(value);
+            } else {
+                value = static_cast<T>(wide);
+                return wide == static_cast<uint64_t>(value);
+            }
+        }
+    }
+    static void toJson(JsonVariant json, T value) {
+        json.set(value);
+    }
+    static bool fromJson(JsonVariantConst json, T& value) {
+        if (!json.is<T>()) {
+            return false;
+        }
+        value = json.as<T>();
+        return true;
+    }
+};
+
+template <typename T>
+struct SchemaCodec<T, typename std::enable_if<
+                          std::is_floating_point<T>::value>::type> {
+    using Bits_t = typename std::conditional<sizeof(T) == 4, uint32_t,
+                                             uint64_t>::type;
+    static_assert(sizeof(T) == sizeof(Bits_t), "Unsupported floating point");
+
+    static void encode(SchemaWriter& writer, T value) {
+        Bits_t bits;
+        std::memcpy(&bits, &value, sizeof(bits));
+        writer.fixed(bits);
+    }
+    static bool decode(SchemaReader& reader, T& value) {
+        Bits_t bits;
+        if (!reader.fixed(bits)) {
+            return false;
+        }
+        std::memcpy(&value, &bits, sizeof(bits));
+        return true;
+    }
+    static void toJson(JsonVariant json, T value) {
+        json.set(value);
+    }
+    static bool fromJson(JsonVariantConst json, T& value) {
+        if (!json.is<T>()) {
+            return false;
+        }
+        value = json.as<T>();
+        return true;
+    }
+};
+
+template <typename T>
+struct SchemaCodec<T, typename std::enable_if<std::is_enum<T>::value>::type> {
+    using Underlying_t = typename std::underlying_type<T>::type;
+    using Codec_t = SchemaCodec<Underlying_t>;
+
+    static void encode(SchemaWriter& writer, T value) {
+        Codec_t::encode(writer, static_cast<Underlying_t>(value));
+    }
+    static bool decode(SchemaReader& reader, T& value) {
+        Underlying_t underlying;
+        if (!Codec_t::decode(reader, underlying)) {
+            return false;
+        }
+        value = static_cast<T>(underlying);
+        return true;
+    }
+    static void toJson(JsonVariant json, T value) {
+        Codec_t::toJson(json, static_cast<Underlying_t>(value));
+    }
+    static bool fromJson(JsonVariantConst json, T& value) {
+        Underlying_t underlying;
+        if (!Codec_t::fromJson(json, underlying)) {
+            return false;
+        }
+        value = static_cast<T>(underlying);
+        return true;
+    }
+};
+
+template <>
+struct SchemaCodec<std::string> {
+    static void encode(SchemaWriter& writer, const std::string& value) {
+        writer.varint(value.size());
+        writer.bytes(value.data(), value.size());
+    }
+    static bool decode(SchemaReader& reader, std::string& value) {
+        uint64_t size;
+        if (!reader.varint(size) || size > reader.remaining()) {
+            return false;
+        }
+        value.resize(size);
+        return reader.bytes(&value[0], size);
+    }
+    static void toJson(JsonVariant json, const std::string& value) {
+        json.set(value);
+    }
+    static bool fromJson(JsonVariantConst json, std::string& value) {
+        if (!json.is<const char*>()) {
+            return false;
+        }
+        value = json.as<const char*>();
+        return true;
+    }
+};
+
+template <typename T>
+struct SchemaCodec<std::vector<T> > {
+    static void encode(SchemaWriter& writer, const std::vector<T>& value) {
+        writer.varint(value.size());
+        for (const T& element : value) {
+            SchemaCodec<T>::encode(writer, element);
+        }
+    }
+    static bool decode(SchemaReader& reader, std::vector<T>& value) {
+        uint64_t size;
+        // every element takes at least one byte, reject counts that cannot
+        // fit before allocating for them
+        if (!reader.varint(size) || size > reader.remaining()) {
+            return false;
+        }
+        value.resize(size);
+        for (size_t i = 0; i < size; i++) {
+            T element;
+            if (!SchemaCodec<T>::decode(reader, element)) {
+                return false;
+            }
+            value[i] = std::move(element);
+        }
+        return true;
+    }
+    static void toJson(JsonVariant json, const std::vector<T>& value) {
+        JsonArray array = json.to<JsonArray>();
+        for (const T& element : value) {
+            SchemaCodec<T>::toJson(array.add<JsonVariant>(), element);
+        }
+    }
+    static bool fromJson(JsonVariantConst json, std::vector<T>& value) {
+        if (!json.is<JsonArrayConst>()) {
+            return false;
+        }
+        JsonArrayConst array = json.as<JsonArrayConst>();
+        value.clear();
+        value.reserve(array.size());
+        for (JsonVariantConst element : array) {
+            T decoded;
+            if (!SchemaCodec<T>::fromJson(element, decoded)) {
+                return false;
+            }
+            value.push_back(std::move(decoded));
+        }
+        return true;
+    }
+};
+
+template <typename T, size_t N>
+struct SchemaCodec<std::array<T, N> > {
+    static void encode(SchemaWriter& writer, const std::array<T, N>& value) {
+        for (const T& element : value) {
+            SchemaCodec<T>::encode(writer, element);
+        }
+    }
+    static bool decode(SchemaReader& reader, std::array<T, N>& value) {
+        for (T& element : value) {
+            if (!SchemaCodec<T>::decode(reader, element)) {
+                return false;
+            }
+        }
+        return true;
+    }
+    static void toJson(JsonVariant json, const std::array<T, N>& value) {
+        JsonArray array = json.to<JsonArray>();
+        for (const T& element : value) {
+            SchemaCodec<T>::toJson(array.add<JsonVariant>(), element);
+        }
+    }
+    static bool fromJson(JsonVariantConst json, std::array<T, N>& value) {
+        if (!json.is<JsonArrayConst>()) {
+            return false;
+        }
+        JsonArrayConst array = json.as<JsonArrayConst>();
+        if (array.size() != N) {
+            return false;
+        }
+        size_t i = 0;
+        for (JsonVariantConst element : array) {
+            if (!SchemaCodec<T>::fromJson(element, value[i++])) {
+                return false;
+            }
+        }
+        return true;
+    }
+};
+
+//* A presence byte, followed by the value if present. JSON uses null.
+template <typename T>
+struct SchemaCodec<std::optional<T> > {
+    static void encode(SchemaWriter& writer, const std::optional<T>& value) {
+        writer.byte(value ? 1 : 0);
+        if (value) {
+            SchemaCodec<T>::encode(writer, *value);
+        }
+    }
+    static bool decode(SchemaReader& reader, std::optional<T>& value) {
+        uint8_t present;
+        if (!reader.byte(present) || present > 1) {
+            return false;
+        }
+        if (!present) {
+            value.reset();
+            return true;
+        }
+        T decoded;
+        if (!SchemaCodec<T>::decode(reader, decoded)) {
+            return false;
+        }
+        value = std::move(decoded);
+        return true;
+    }
+    static void toJson(JsonVariant json, const std::optional<T>& value) {
+        if (value) {
+            SchemaCodec<T>::toJson(json, *value);
+        }
+    }
+    static bool fromJson(JsonVariantConst json, std::optional<T>& value) {
+        if (json.isNull()) {
+            value.reset();
+            return true;
+        }
+        T decoded;
+        if (!SchemaCodec<T>::fromJson(json, decoded)) {
+            return false;
+        }
+        value = std::move(decoded);
+        return true;
+    }
+};
+
+//* Structs are encoded field by field in declaration order, without names
+//* or tags, the schema tells the decoder what comes next
+template <typename T>
+struct SchemaCodec<T,
+                   typename std::enable_if<MessageSchema<T>::defined>::type> {
+    static void encode(SchemaWriter& writer, const T& value) {
+        std::apply(
+            [&](const auto&... field) {
+                (..., encodeField(writer, value.*(field.member)));
+            },
+            MessageSchema<T>::fields);
+    }
+    static bool decode(SchemaReader& reader, T& value) {
+        return std::apply(
+            [&](const auto&... field) {
+                return (... && decodeField(reader, value.*(field.member)));
+            },
+            MessageSchema<T>::fields);
+    }
+    static void toJson(JsonVariant json, const T& value) {
+        JsonObject object = json.to<JsonObject>();
+        std::apply(
+            [&](const auto&... field) {
+                (..., fieldToJson(object, field.name, value.*(field.member)));
+            },
+            MessageSchema<T>::fields);
+    }
+    static bool fromJson(JsonVariantConst json, T& value) {
+        return std::apply(
+            [&](const auto&... field) {
+                return (... && fieldFromJson(json, field.name,
+                                             value.*(field.member)));
+            },
+            MessageSchema<T>::fields);
+    }
+
+   private:
+    template <typename M>
+    static void encodeField(SchemaWriter& writer, const M& member) {
+        SchemaCodec<M>::encode(writer, member);
+    }
+    template <typename M>
+    static bool decodeField(SchemaReader& reader, M& member) {
+        return SchemaCodec<M>::decode(reader, member);
+    }
+    template <typename M>
+    static void fieldToJson(JsonObject& object, const char* name,
+                            const M& member) {
+        SchemaCodec<M>::toJson(object[name].template to<JsonVariant>(),
+                               member);
+    }
+    template <typename M>
+    static bool fieldFromJson(JsonVariantConst json, const char* name,
+                              M& member) {
+        return SchemaCodec<M>::fromJson(json[name], member);
+    }
+};
+
+/**
+ * @brief Encode a message into its packed binary form
+ * @param out Receives the encoding, its previous content is discarded but
+ * its capacity reused
+ */
+template <typename T>
+void encodeMessage(const T& message, std::vector<uint8_t>& out) {
+    static_assert(MessageSchema<T>::defined,
+                  "Message has no schema, see EASYHELPERS_MESSAGE_SCHEMA");
+    out.clear();
+    SchemaWriter writer(out);
+    SchemaCodec<T>::encode(writer, message);
+}
+
+template <typename T>
+std::vector<uint8_t> encodeMessage(const T& message) {
+    std::vector<uint8_t> out;
+    encodeMessage(message, out);
+    return out;
+}
+
+/**
+ * @brief Decode a message from its packed binary form
+ * @return false if the input is truncated, malformed or has trailing bytes
+ */
+template <typename T>
+bool decodeMessage(const uint8_t* data, size_t length, T& message) {
+    static_assert(MessageSchema<T>::defined,
+                  "Message has no schema, see EASYHELPERS_MESSAGE_SCHEMA");
+    SchemaReader reader(data, length);
+    return SchemaCodec<T>::decode(reader, message) && reader.remaining() == 0;
+}
+
+/**
+ * @brief Convert a message to a `JsonDocument`, keyed by field name
+ */
+template <typename T>
+JsonDocument toJsonDocument(const T& message) {
+    JsonDocument doc;
+    SchemaCodec<T>::toJson(doc.to<JsonVariant>(), message);
+    return doc;
+}
+
+/**
+ * @brief Fill a message from a `JsonDocument`
+ * @return false if a field is missing or has the wrong type
+ */
+template <typename T>
+bool fromJsonDocument(const JsonDocument& doc, T& message) {
+    return SchemaCodec<T>::fromJson(doc.as<JsonVariantConst>(), message);
+}
+
+}  // namespace Helpers
+
+#define EASYHELPERS_SCHEMA_FIELD(T, f) Helpers::schemaField(#f, &T::f)
+#define EASYHELPERS_SCHEMA_F1(T, a) EASYHELPERS_SCHEMA_FIELD(T, a)
+#define EASYHELPERS_SCHEMA_F2(T, a, ...) \
+    EASYHELPERS_SCHEMA_FIELD(T, a), EASYHELPERS_SCHEMA_F1(T, __VA_ARGS__)
+#define EASYHELPERS_SCHEMA_F3(T, a, ...) \
+    EASYHELPERS_SCHEMA_FIELD(T, a), EASYHELPERS_SCHEMA_F2(T, __VA_ARGS__)
+#define EASYHELPERS_SCHEMA_F4(T, a, ...) \
+    EASYHELPERS_SCHEMA_FIELD(T, a), EASYHELPERS_SCHEMA_F3(T, __VA_ARGS__)
+#define EASYHELPERS_SCHEMA_F5(T, a, ...) \
+    EASYHELPERS_SCHEMA_FIELD(T, a), EASYHELPERS_SCHEMA_F4(T, __VA_ARGS__)
+#define EASYHELPERS_SCHEMA_F6(T, a, ...) \
+    EASYHELPERS_SCHEMA_FIELD(T, a), EASYHELPERS_SCHEMA_F5(T, __VA_ARGS__)
+#define EASYHELPERS_SCHEMA_F7(T, a, ...) \
+    EASYHELPERS_SCHEMA_FIELD(T, a), EASYHELPERS_SCHEMA_F6(T, __VA_ARGS__)
+#define EASYHELPERS_SCHEMA_F8(T, a, ...) \
+    EASYHELPERS_SCHEMA_FIELD(T, a), EASYHELPERS_SCHEMA_F7(T, __VA_ARGS__)
+#define EASYHELPERS_SCHEMA_F9(T, a, ...) \
+    EASYHELPERS_SCHEMA_FIELD(T, a), EASYHELPERS_SCHEMA_F8(T, __VA_ARGS__)
+#define EASYHELPERS_SCHEMA_F10(T, a, ...) \
+    EASYHELPERS_SCHEMA_FIELD(T, a), EASYHELPERS_SCHEMA_F9(T, __VA_ARGS__)
+#define EASYHELPERS_SCHEMA_F11(T, a, ...) \
+    EASYHELPERS_SCHEMA_FIELD(T, a), EASYHELPERS_SCHEMA_F10(T, __VA_ARGS__)
+#define EASYHELPERS_SCHEMA_F12(T, a, ...) \
+    EASYHELPERS_SCHEMA_FIELD(T, a), EASYHELPERS_SCHEMA_F11(T, __VA_ARGS__)
+#define EASYHELPERS_SCHEMA_F13(T, a, ...) \
+    EASYHELPERS_SCHEMA_FIELD(T, a), EASYHELPERS_SCHEMA_F12(T, __VA_ARGS__)
+#define EASYHELPERS_SCHEMA_F14(T, a, ...) \
+    EASYHELPERS_SCHEMA_FIELD(T, a), EASYHELPERS_SCHEMA_F13(T, __VA_ARGS__)
+#define EASYHELPERS_SCHEMA_F15(T, a, ...) \
+    EASYHELPERS_SCHEMA_FIELD(T, a), EASYHELPERS_SCHEMA_F14(T, __VA_ARGS__)
+#define EASYHELPERS_SCHEMA_F16(T, a, ...) \
+    EASYHELPERS_SCHEMA_FIELD(T, a), EASYHELPERS_SCHEMA_F15(T, __VA_ARGS__)
+#define EASYHELPERS_SCHEMA_NTH(_1, _2, _3, _4, _5, _6, _7, _8, _9, _10, _11, \
+                               _12, _13, _14, _15, _16, N, ...)              \
+    N
+#define EASYHELPERS_SCHEMA_COUNT(...)                                       \
+    EASYHELPERS_SCHEMA_NTH(__VA_ARGS__, 16, 15, 14, 13, 12, 11, 10, 9, 8, 7, \
+                           6, 5, 4, 3, 2, 1, )
+#define EASYHELPERS_SCHEMA_CAT_(a, b) a##b
+#define EASYHELPERS_SCHEMA_CAT(a, b) EASYHELPERS_SCHEMA_CAT_(a, b)
+#define EASYHELPERS_SCHEMA_FIELDS(T, ...)                                   \
+    EASYHELPERS_SCHEMA_CAT(EASYHELPERS_SCHEMA_F,                            \
+                           EASYHELPERS_SCHEMA_COUNT(__VA_ARGS__))(T,         \
+                                                                  __VA_ARGS__)
+
+/**
+ * @brief Declare the schema of a message struct, up to 16 fields
+ * @note Invoke at global scope, list the fields in the order they are
+ * encoded. The encoding carries no field names or tags, so both ends must
+ * agree on the schema.
+ *
+ * @code
+ * ```
+ * struct Reading {
+ *     uint32_t id;
+ *     float temperature;
+ *     std::vector<int16_t> samples;
+ * };
+ * EASYHELPERS_MESSAGE_SCHEMA(Reading, id, temperature, samples);
+ *
+ * auto bytes = Helpers::encodeMessage(reading);
+ * JsonDocument doc = Helpers::toJsonDocument(reading);
+ * ```
+ */
+#define EASYHELPERS_MESSAGE_SCHEMA(Type, ...)                \
+    template <>                                              \
+    struct Helpers::MessageSchema<Type> {                    \
+        static constexpr bool defined = true;                \
+        static constexpr auto fields = std::make_tuple(      \
+            EASYHELPERS_SCHEMA_FIELDS(Type, __VA_ARGS__));   \
+    }
@@ -1,14 +1,138 @@
 #pragma once
 #include <algorithm>
+#include <cstddef>
 #include <memory>
+#include <new>
 #include <string>
+#include <type_traits>
 #include <unordered_map>
+#include <utility>
 #include <vector>
+#include "event_recorder.hpp"
 #include "freertos/semphr.h"
 #include "id_interface.hpp"
+#include "memory_accounting.hpp"
+
+/**
+ * @brief Bytes available to store a callable inside a `Subscription`
+ * @note Override with a build flag, e.g.
+ * `-DEASYHELPERS_SUBSCRIPTION_CAPACITY=32`, if larger captures are needed
+ */
+#ifndef EASYHELPERS_SUBSCRIPTION_CAPACITY
+#    define EASYHELPERS_SUBSCRIPTION_CAPACITY (4 * sizeof(void*))
+#endif
 
 namespace Helpers {
 
+template <typename EnumT, typename PayloadT>
+class ISubject;
+
+template <typename EnumT, typename PayloadT>
+struct SubscriptionInvoker {
+    using type = void (*)(void*, const EnumT&, const PayloadT&);
+};
+
+template <typename EnumT>
+struct SubscriptionInvoker<EnumT, void> {
+    using type = void (*)(void*, const EnumT&);
+};
+
+/**
+ * @brief RAII handle of a callback subscribed to an `ISubject`
+ * @tparam EnumT The Enum Type for the Event
+ * @tparam PayloadT The payload passed along with the event
+ * @note The callable is stored inside the handle itself and the subject only
+ * links the handles together, so subscribing never allocates.
+ * @note The callback is detached when the handle is destroyed or reset, the
+ * handle can be moved but not copied.
+ */
+template <typename EnumT, typename PayloadT = void>
+class Subscription {
+    friend class ISubject<EnumT, PayloadT>;
+    using Invoke_t = typename SubscriptionInvoker<EnumT, PayloadT>::type;
+    using Relocate_t = void (*)(void* destination, void* source);
+
+    ISubject<EnumT, PayloadT>* subject = nullptr;
+    Subscription* prev = nullptr;
+    Subscription* next = nullptr;
+    uint64_t key = 0;
+    bool keyed = false;
+    Invoke_t invoke = nullptr;
+    Relocate_t relocate = nullptr;
+    alignas(std::max_align_t) unsigned char
+        storage[EASYHELPERS_SUBSCRIPTION_CAPACITY];
+
+    template <typename F>
+    static void invokeCallable(void* callable, const EnumT& event) {
+        (*static_cast<F*>(callable))(event);
+    }
+
+    template <typename F, typename T>
+    static void invokeCallable(void* callable, const EnumT& event,
+                               const T& payload) {
+        (*static_cast<F*>(callable))(event, payload);
+    }
+
+    // move the callable from source into destination, or only destroy source
+    // when destination is null
+    template <typename F>
+    static void relocateCallable(void* destination, void* source) {
+        F* callable = static_cast<F*>(source);
+        if (destination) {
+            new (destination) F(std::move(*callable));
+        }
+        callable->~F();
+    }
+
+    void destroyCallable() {
+        if (relocate) {
+            relocate(nullptr, storage);
+            relocate = nullptr;
+            invoke = nullptr;
+        }
+    }
+
+    void moveFrom(Subscription& other);
+
+   public:
+    Subscription() = default;
+    Subscription(const Subscription&) = delete;
+    Subscription& operator=(const Subscription&) = delete;
+
+    Subscription(Subscription&& other) noexcept {
+        moveFrom(other);
+    }
+
+    Subscription& operator=(Subscription&& other) noexcept {
+        if (this != &other) {
+            reset();
+            moveFrom(other);
+        }
+        return *this;
+    }
+
+    ~Subscription() {
+        reset();
+    }
+
+    /**
+     * @brief Detach the callback from its subject and destroy it
+     */
+    void reset();
+
+    /**
+     * @brief Check if the callback is still attached to a subject
+     * @note A subscription is released when its subject is destroyed
+     */
+    bool active() const {
+        return subject != nullptr;
+    }
+
+    explicit operator bool() const {
+        return active();
+    }
+};
+
 template <typename EnumT, typename PayloadT = void>
 class IObserver : public IId {
    public:
@@ -27,8 +151,60 @@ class ISubject {
     SemaphoreHandle_t mutex;
     using ObserverPtr_t = std::weak_ptr<IObserver<EnumT, PayloadT> >;
     using ObserversByNameMap_t = std::unordered_map<uint64_t, ObserverPtr_t>;
+    using Subscription_t = Subscription<EnumT, PayloadT>;
 
     ObserversByNameMap_t observers;
+    Subscription_t* subscriptions = nullptr;
+
+    friend class Subscription<EnumT, PayloadT>;
+
+    void link(Subscription_t* subscription) {
+        subscription->subject = this;
+        subscription->prev = nullptr;
+        subscription->next = subscriptions;
+        if (subscriptions) {
+            subscriptions->prev = subscription;
+        }
+        subscriptions = subscription;
+    }
+
+    void unlink(Subscription_t* subscription) {
+        if (subscription->prev) {
+            subscription->prev->next = subscription->next;
+        } else {
+            subscriptions = subscription->next;
+        }
+        if (subscription->next) {
+            subscription->next->prev = subscription->prev;
+        }
+        subscription->subject = nullptr;
+        subscription->prev = nullptr;
+        subscription->next = nullptr;
+    }
+
+    template <typename F>
+    Subscription_t makeSubscription(F&& callback, bool keyed, uint64_t key) {
+        using Callable_t = typename std::decay<F>::type;
+        static_assert(sizeof(Callable_t) <= EASYHELPERS_SUBSCRIPTION_CAPACITY,
+                      "Callback captures too much state, raise "
+                      "EASYHELPERS_SUBSCRIPTION_CAPACITY");
+        static_assert(alignof(Callable_t) <= alignof(std::max_align_t),
+                      "Callback is over-aligned");
+
+        Subscription_t subscription;
+        new (subscription.storage) Callable_t(std::forward<F>(callback));
+        subscription.invoke =
+            &Subscription_t::template invokeCallable<Callable_t>;
+        subscription.relocate =
+            &Subscription_t::template relocateCallable<Callable_t>;
+        subscription.keyed = keyed;
+        subscription.key = key;
+
+        xSemaphoreTake(mutex, portMAX_DELAY);
+        link(&subscription);
+        xSemaphoreGive(mutex);
+        return subscription;
+    }
 
    public:
     ISubject() {
@@ -37,10 +213,51 @@ class ISubject {
 
     virtual ~ISubject() {
         detachAll();
+        xSemaphoreTake(mutex, portMAX_DELAY);
+        while (subscriptions) {
+            unlink(subscriptions);
+        }
+        xSemaphoreGive(mutex);
         vSemaphoreDelete(mutex);
     }
 
+    /**
+     * @brief Subscribe a callable to every `notifyAll`
+     * @param callback A lambda, functor or function pointer invoked as
+     * `callback(event)`, or `callback(event, payload)` for subjects with a
+     * payload
+     * @return Subscription The handle keeping the callback attached
+     * @note The callable is stored in the returned handle, it must fit in
+     * `EASYHELPERS_SUBSCRIPTION_CAPACITY` bytes, nothing is allocated
+     * @note Like `update`, the callback runs with the subject locked and must
+     * not subscribe, reset subscriptions or attach observers on the same
+     * subject
+     *
+     * @code
+     * ```
+     * auto subscription = subject.subscribe([](const EventID& event) {
+     *     // ...
+     * });
+     * ```
+     */
+    template <typename F>
+    Subscription_t subscribe(F&& callback) {
+        return makeSubscription(std::forward<F>(callback), false, 0);
+    }
+
+    /**
+     * @brief Subscribe a callable to every `notifyAll` and to `notify` calls
+     * targeting `key`
+     * @param key The key the callable answers to, as an observer ID would
+     * @param callback The callable, see `subscribe(F&&)`
+     */
+    template <typename F>
+    Subscription_t subscribe(uint64_t key, F&& callback) {
+        return makeSubscription(std::forward<F>(callback), true, key);
+    }
+
     void attach(ObserverPtr_t observerWeak) {
+        EASYHELPERS_MEMORY_SCOPE("ISubject", this);
         xSemaphoreTake(mutex, portMAX_DELAY);
         if (auto observer = observerWeak.lock()) {
             observers[observer->getID()] = observerWeak;
@@ -87,6 +304,12 @@ class ISubject {
                 observer->update(event, payload);
             }
         }
+        for (auto* subscription = subscriptions; subscription;
+             subscription = subscription->next) {
+            if (subscription->keyed && subscription->key == key) {
+                subscription->invoke(subscription->storage, event, payload);
+            }
+        }
         xSemaphoreGive(mutex);
     }
 
@@ -101,6 +324,10 @@ class ISubject {
                 observer->update(event, payload);
             }
         }
+        for (auto* subscription = subscriptions; subscription;
+             subscription = subscription->next) {
+            subscription->invoke(subscription->storage, event, payload);
+        }
         xSemaphoreGive(mutex);
     }
 
@@ -108,6 +335,11 @@ class ISubject {
     template <typename T = PayloadT>
     typename std::enable_if<std::is_void<T>::value>::type notify(uint64_t key,
                                                                  EnumT event) {
+        if (auto recorder = EventRecorder::active()) {
+            recorder->record(EventRecorder::NOTIFY,
+                             EventRecorder::subjectID(this), key,
+                             static_cast<int64_t>(event));
+        }
         xSemaphoreTake(mutex, portMAX_DELAY);
         for (const auto& [observerKey, observerWeak] : observers) {
             if (observerKey != key) {
@@ -118,6 +350,12 @@ class ISubject {
                 observer->update(event);
             }
         }
+        for (auto* subscription = subscriptions; subscription;
+             subscription = subscription->next) {
+            if (subscription->keyed && subscription->key == key) {
+                subscription->invoke(subscription->storage, event);
+            }
+        }
         xSemaphoreGive(mutex);
     }
 
@@ -125,13 +363,74 @@ class ISubject {
     template <typename T = PayloadT>
     typename std::enable_if<std::is_void<T>::value>::type notifyAll(
         EnumT event) {
+        if (auto recorder = EventRecorder::active()) {
+            recorder->record(EventRecorder::NOTIFY_ALL,
+                             EventRecorder::subjectID(this), 0,
+                             static_cast<int64_t>(event));
+        }
         xSemaphoreTake(mutex, portMAX_DELAY);
         for (const auto& [observerKey, observerWeak] : observers) {
             if (auto observer = observerWeak.lock()) {
                 observer->update(event);
             }
         }
+        for (auto* subscription = subscriptions; subscription;
+             subscription = subscription->next) {
+            subscription->invoke(subscription->storage, event);
+        }
         xSemaphoreGive(mutex);
     }
 };
+
+template <typename EnumT, typename PayloadT>
+void Subscription<EnumT, PayloadT>::moveFrom(Subscription& other) {
+    if (!other.relocate) {
+        return;
+    }
+
+    // hold the subject while the callable changes place so that a concurrent
+    // notify never sees a half moved handle
+    auto* owner = other.subject;
+    if (owner) {
+        xSemaphoreTake(owner->mutex, portMAX_DELAY);
+    }
+
+    other.relocate(storage, other.storage);
+    invoke = other.invoke;
+    relocate = other.relocate;
+    keyed = other.keyed;
+    key = other.key;
+    other.invoke = nullptr;
+    other.relocate = nullptr;
+
+    if (owner) {
+        // take over the other handle's place in the subject's list
+        subject = owner;
+        prev = other.prev;
+        next = other.next;
+        if (prev) {
+            prev->next = this;
+        } else {
+            owner->subscriptions = this;
+        }
+        if (next) {
+            next->prev = this;
+        }
+        other.subject = nullptr;
+        other.prev = nullptr;
+        other.next = nullptr;
+        xSemaphoreGive(owner->mutex);
+    }
+}
+
+template <typename EnumT, typename PayloadT>
+void Subscription<EnumT, PayloadT>::reset() {
+    if (subject) {
+        auto* owner = subject;
+        xSemaphoreTake(owner->mutex, portMAX_DELAY);
+        owner->unlink(this);
+        xSemaphoreGive(owner->mutex);
+    }
+    destroyCallable();
+}
 }  // namespace Helpers
@@ -0,0 +1,160 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace Helpers {
+
+/**
+ * @brief Append a `[=====>    ]` bar of `width` cells to `out`
+ * @note `progress` beyond `total` draws a full bar
+ */
+void appendProgressBar(std::string& out, uint64_t progress, uint64_t total,
+                       size_t width);
+
+/**
+ * @brief A progress counter shared between workers and a `ProgressRenderer`
+ * @note `add` is a single relaxed atomic add, workers never block or write
+ * to the terminal themselves. Counts are word sized, 64-bit atomics are not
+ * lock free on 32-bit targets such as the ESP32.
+ */
+class ProgressBar {
+    friend class ProgressRenderer;
+    using Clock_t = std::chrono::steady_clock;
+
+    static_assert(std::atomic<size_t>::is_always_lock_free,
+                  "ProgressBar::add must not take a lock");
+
+    std::string label;
+    std::atomic<size_t> current{0};
+    std::atomic<size_t> total;
+    std::atomic<bool> finished{false};
+
+    //* Sampled by the renderer only
+    Clock_t::time_point sampleTime;
+    size_t sampleCount = 0;
+    double rate = 0;
+
+   public:
+    ProgressBar(const std::string& label, size_t total)
+        : label(label), total(total), sampleTime(Clock_t::now()) {}
+
+    void add(size_t count = 1) {
+        current.fetch_add(count, std::memory_order_relaxed);
+    }
+
+    void set(size_t value) {
+        current.store(value, std::memory_order_relaxed);
+    }
+
+    void setTotal(size_t value) {
+        total.store(value, std::memory_order_relaxed);
+    }
+
+    void finish() {
+        finished.store(true, std::memory_order_relaxed);
+    }
+
+    size_t getCurrent() const {
+        return current.load(std::memory_order_relaxed);
+    }
+
+    size_t getTotal() const {
+        return total.load(std::memory_order_relaxed);
+    }
+
+    bool isFinished() const {
+        return finished.load(std::memory_order_relaxed) ||
+               getCurrent() >= getTotal();
+    }
+
+    const std::string& getLabel() const {
+        return label;
+    }
+
+    /**
+     * @brief Smoothed rate in units per second, as of the last rendered frame
+     */
+    double getRate() const {
+        return rate;
+    }
+};
+
+/**
+ * @brief Draws any number of `ProgressBar` at a capped frame rate
+ * @note Each frame is built in a reusable buffer and written with a single
+ * call, previous frames are overwritten in place with ANSI cursor movements
+ *
+ * @code
+ * ```
+ * Helpers::ProgressRenderer renderer(std::cout, 10);
+ * auto download = renderer.addBar("download", 1000);
+ * renderer.start();
+ * // worker threads: download->add();
+ * renderer.stop();
+ * ```
+ */
+class ProgressRenderer {
+    using Clock_t = std::chrono::steady_clock;
+
+    std::ostream& out;
+    std::chrono::milliseconds frameInterval;
+    size_t barWidth;
+
+    std::mutex mutex;
+    std::vector<std::shared_ptr<ProgressBar> > bars;
+    std::string frame;
+    size_t linesDrawn = 0;
+    Clock_t::time_point lastFrame;
+
+    std::thread worker;
+    std::atomic<bool> running{false};
+
+    void appendLine(ProgressBar& bar, Clock_t::time_point now);
+
+   public:
+    /**
+     * @brief Construct a new Progress Renderer
+     * @param out The stream frames are written to
+     * @param maxFps The maximum number of frames drawn per second
+     * @param barWidth The number of cells of each bar
+     */
+    ProgressRenderer(std::ostream& out = std::cout, uint32_t maxFps = 10,
+                     size_t barWidth = 40);
+    ~ProgressRenderer();
+
+    ProgressRenderer(const ProgressRenderer&) = delete;
+    ProgressRenderer& operator=(const ProgressRenderer&) = delete;
+
+    /**
+     * @brief Create a bar drawn by this renderer
+     */
+    std::shared_ptr<ProgressBar> addBar(const std::string& label,
+                                        size_t total);
+
+    void removeBar(const std::shared_ptr<ProgressBar>& bar);
+
+    /**
+     * @brief Draw a frame if the frame interval has elapsed
+     * @param force Draw even if the last frame is too recent
+     * @return true if a frame was written
+     */
+    bool render(bool force = false);
+
+    /**
+     * @brief Draw frames from a background thread until `stop`
+     */
+    void start();
+
+    /**
+     * @brief Stop the background thread and draw a final frame
+     */
+    void stop();
+};
+}  // namespace Helpers
@@ -0,0 +1,157 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+#include "freertos/semphr.h"
+#include "logger.hpp"
+
+namespace Helpers {
+
+/**
+ * @brief A log record recovered from a `RingLogSink` region
+ */
+struct LogRecord {
+    uint64_t sequence;
+    uint64_t timestampMs;
+    uint8_t level;
+    std::string message;
+};
+
+/**
+ * @brief Log sink appending records to a circular, crash persistent, memory
+ * region
+ * @note The region is either a memory-mapped file (`openFile`, Linux) or any
+ * memory that survives a reset, e.g. an `RTC_NOINIT_ATTR` buffer on the
+ * ESP32. A record is a plain `memcpy` into the region, there is no syscall
+ * per record.
+ * @note Each record carries a sequence number and a checksum, and the write
+ * cursor is only advanced once the record is complete, so a crash mid-write
+ * loses at most that record. Use `recoverRingLog` to read the ordered tail
+ * back after a restart.
+ * @note A region that already holds a log of the same size is appended to,
+ * anything else is formatted. Appending resumes after the last valid record,
+ * with the sequence that follows it, so a reset mid-write never breaks the
+ * sequence `recoverRingLog` follows.
+ *
+ * @code
+ * ```
+ * RTC_NOINIT_ATTR static uint8_t logRegion[4096];
+ *
+ * void setup() {
+ *     for (auto& record : Helpers::recoverRingLog(logRegion,
+ *                                                 sizeof(logRegion))) {
+ *         Serial.println(record.message.c_str());
+ *     }
+ *     static Helpers::RingLogSink sink(logRegion, sizeof(logRegion));
+ *     Helpers::Logger::setSink(&sink);
+ * }
+ * ```
+ */
+class RingLogSink : public LogSink {
+   public:
+    enum Overflow_e : uint8_t {
+        //* Overwrite the oldest records, the log rotates in place
+        OVERWRITE_OLDEST,
+        //* Keep the oldest records and drop new ones once full
+        DROP_NEWEST,
+    };
+
+    //* Bytes taken by the region header
+    static constexpr size_t HEADER_SIZE = 48;
+    //* Bytes taken by each record on top of its message
+    static constexpr size_t RECORD_OVERHEAD = 32;
+
+   private:
+    class MappedFile;
+
+    SemaphoreHandle_t mutex;
+    uint8_t* region;
+    uint8_t* data;
+    uint64_t capacity;
+    Overflow_e overflow;
+    std::atomic<uint64_t> droppedCount{0};
+    std::unique_ptr<MappedFile> file;
+
+    RingLogSink(std::unique_ptr<MappedFile> file, Overflow_e overflow);
+
+    void attach();
+
+#if defined(__linux__)
+    friend std::vector<LogRecord> recoverRingLog(const std::string& path);
+#endif
+
+   public:
+    /**
+     * @brief Construct a sink over a caller provided region
+     * @param region The memory holding the log, at least `HEADER_SIZE` plus
+     * one record, aligned to 8 bytes
+     * @param size The size of the region in bytes, only the first 1 GiB is
+     * used past the header
+     * @param overflow What to do once the region is full
+     */
+    RingLogSink(void* region, size_t size,
+                Overflow_e overflow = OVERWRITE_OLDEST);
+    ~RingLogSink() override;
+
+    RingLogSink(const RingLogSink&) = delete;
+    RingLogSink& operator=(const RingLogSink&) = delete;
+
+#if defined(__linux__)
+    /**
+     * @brief Open, or create, a memory-mapped log file
+     * @param path The file backing the log
+     * @param size The size of the file, existing files of another size are
+     * resized and formatted
+     * @return std::unique_ptr<RingLogSink> The sink, or `nullptr` if the file
+     * could not be mapped
+     */
+    static std::unique_ptr<RingLogSink> openFile(
+        const std::string& path, size_t size,
+        Overflow_e overflow = OVERWRITE_OLDEST);
+#endif
+
+    void write(uint8_t level, const char* message, size_t length) override;
+
+    /**
+     * @brief Schedule the mapped file to be written back to disk
+     * @note Not needed to survive a process crash, only a power loss. A no-op
+     * for plain memory regions.
+     */
+    void flush() override;
+
+    /**
+     * @brief Discard every record
+     */
+    void clear();
+
+    /**
+     * @brief The number of records dropped because the region was full, or
+     * the record larger than the region
+     */
+    uint64_t dropped() const {
+        return droppedCount.load(std::memory_order_relaxed);
+    }
+
+    uint64_t getCapacity() const {
+        return capacity;
+    }
+};
+
+/**
+ * @brief Recover the records of a `RingLogSink` region, oldest first
+ * @note Stops at the first torn or corrupt record, an unformatted region
+ * yields no records
+ */
+std::vector<LogRecord> recoverRingLog(const void* region, size_t size);
+
+#if defined(__linux__)
+/**
+ * @brief Recover the records of a memory-mapped log file, oldest first
+ */
+std::vector<LogRecord> recoverRingLog(const std::string& path);
+#endif
+
+}  // namespace Helpers
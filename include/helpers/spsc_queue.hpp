@@ -0,0 +1,112 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+namespace Helpers {
+
+/**
+ * @brief A bounded lock free queue for one producer and one consumer
+ * @tparam T The element type, must be default constructible
+ * @note The capacity is rounded up to a power of two. Each side keeps a
+ * cached copy of the other side's index, so the shared indices are only
+ * read when the queue looks full or empty.
+ * @note Popped slots keep their moved-from element until overwritten.
+ * @note The indices are word sized, so they stay lock free on 32 bit
+ * targets. They wrap around safely, the capacity is a power of two and
+ * every comparison is an unsigned difference.
+ *
+ * @code
+ * ```
+ * Helpers::SpscQueue<JsonDocument> queue(32);
+ * // producer thread
+ * queue.tryPush(std::move(doc));
+ * // consumer thread
+ * JsonDocument next;
+ * while (queue.tryPop(next)) { ... }
+ * ```
+ */
+template <typename T>
+class SpscQueue {
+    static_assert(std::atomic<size_t>::is_always_lock_free,
+                  "SpscQueue must be lock free");
+
+    std::vector<T> slots;
+    size_t mask;
+    //* Consumer side
+    alignas(64) std::atomic<size_t> head{0};
+    size_t cachedTail = 0;
+    //* Producer side
+    alignas(64) std::atomic<size_t> tail{0};
+    size_t cachedHead = 0;
+
+    static size_t roundUp(size_t capacity) {
+        size_t size = 1;
+        while (size < capacity) {
+            size <<= 1;
+        }
+        return size;
+    }
+
+   public:
+    explicit SpscQueue(size_t capacity)
+        : slots(roundUp(capacity ? capacity : 1)), mask(slots.size() - 1) {}
+
+    SpscQueue(const SpscQueue&) = delete;
+    SpscQueue& operator=(const SpscQueue&) = delete;
+
+    /**
+     * @brief Push an element, from the producer thread only
+     * @return false if the queue is full, `value` is then left untouched
+     */
+    template <typename U>
+    bool tryPush(U&& value) {
+        size_t position = tail.load(std::memory_order_relaxed);
+        if (position - cachedHead >= slots.size()) {
+            cachedHead = head.load(std::memory_order_acquire);
+            if (position - cachedHead >= slots.size()) {
+                return false;
+            }
+        }
+        slots[position & mask] = std::forward<U>(value);
+        tail.store(position + 1, std::memory_order_release);
+        return true;
+    }
+
+    /**
+     * @brief Pop an element, from the consumer thread only
+     * @return false if the queue is empty
+     */
+    bool tryPop(T& value) {
+        size_t position = head.load(std::memory_order_relaxed);
+        if (position == cachedTail) {
+            cachedTail = tail.load(std::memory_order_acquire);
+            if (position == cachedTail) {
+                return false;
+            }
+        }
+        value = std::move(slots[position & mask]);
+        head.store(position + 1, std::memory_order_release);
+        return true;
+    }
+
+    /**
+     * @brief The number of elements queued, approximate while both sides run
+     */
+    size_t size() const {
+        // head first, it can only move towards the tail read after it
+        size_t position = head.load(std::memory_order_acquire);
+        return tail.load(std::memory_order_acquire) - position;
+    }
+
+    bool empty() const {
+        return size() == 0;
+    }
+
+    size_t capacity() const {
+        return slots.size();
+    }
+};
+}  // namespace Helpers
@@ -0,0 +1,52 @@
+#pragma once
+#include <cstddef>
+#include <functional>
+#include <vector>
+
+namespace Helpers {
+
+/**
+ * @brief Runs tasks after the tasks they depend on, independent tasks
+ * concurrently on a small worker pool
+ * @note Tasks are numbered from 0. The calling thread is one of the
+ * workers, with `workers` of 1 everything runs on it in dependency order.
+ * @note Workers are `std::thread`s, on ESP32 their stack size is set with
+ * `esp_pthread_set_cfg`.
+ *
+ * @code
+ * ```
+ * Helpers::TaskGraph graph(3);
+ * graph.addDependency(2, 0);  // 2 runs once 0 has finished
+ * graph.run([&](size_t task) { init(task); }, 2);
+ * ```
+ */
+class TaskGraph {
+    std::vector<std::vector<size_t> > dependents;
+    std::vector<size_t> dependencyCount;
+
+   public:
+    explicit TaskGraph(size_t tasks)
+        : dependents(tasks), dependencyCount(tasks, 0) {}
+
+    size_t size() const {
+        return dependents.size();
+    }
+
+    /**
+     * @brief `task` only runs once `dependency` has returned
+     */
+    void addDependency(size_t task, size_t dependency) {
+        dependents[dependency].push_back(task);
+        dependencyCount[task]++;
+    }
+
+    /**
+     * @brief Run every task whose dependencies can be satisfied
+     * @param workers The maximum number of tasks running at once
+     * @return The tasks that did not run because they are part of, or depend
+     * on, a dependency cycle
+     */
+    std::vector<size_t> run(const std::function<void(size_t)>& task,
+                            size_t workers);
+};
+}  // namespace Helpers
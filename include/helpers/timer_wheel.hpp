@@ -0,0 +1,270 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+namespace Helpers {
+
+/**
+ * @brief Hierarchical timing wheel
+ * @tparam ActionT The data attached to each timer, handed back on expiry
+ * @note Four levels of 64 slots cover 2^24 ticks, longer delays are parked
+ * in the last level and cascaded again until they fit.
+ * @note Scheduling and cancelling are O(1). Timers live in intrusive lists
+ * linked by index, so the node pool can grow while timers are pending.
+ * @note Expiry is two-phased: `collect` moves every due timer to an expiring
+ * list in one pass, `popExpired` then hands them out one by one. This lets
+ * the owner fire them without holding its lock.
+ * @note The wheel is not synchronized, see `EventTimer` for a locked wrapper.
+ */
+template <typename ActionT>
+class TimerWheel {
+   public:
+    using TimerID_t = uint64_t;
+    static constexpr TimerID_t INVALID_TIMER = 0;
+
+   private:
+    static constexpr uint32_t SLOT_BITS = 6;
+    static constexpr uint32_t SLOTS = 1u << SLOT_BITS;
+    static constexpr uint32_t SLOT_MASK = SLOTS - 1;
+    static constexpr uint32_t LEVELS = 4;
+    static constexpr uint64_t MAX_DELTA = 1ull << (SLOT_BITS * LEVELS);
+    //* Slot sentinels come first, followed by the expiring list sentinel
+    static constexpr uint32_t EXPIRING = LEVELS * SLOTS;
+    static constexpr uint32_t FIRST_TIMER = EXPIRING + 1;
+
+    struct Node {
+        uint32_t prev = 0;
+        uint32_t next = 0;
+        uint32_t generation = 1;
+        bool active = false;
+        uint64_t expires = 0;
+        uint64_t period = 0;
+        ActionT action{};
+    };
+
+    std::vector<Node> nodes;
+    std::vector<uint32_t> freeNodes;
+    uint64_t current;
+    size_t activeCount = 0;
+
+    static TimerID_t makeID(uint32_t index, uint32_t generation) {
+        return (static_cast<uint64_t>(generation) << 32) | index;
+    }
+
+    bool isEmpty(uint32_t sentinel) const {
+        return nodes[sentinel].next == sentinel;
+    }
+
+    void linkBack(uint32_t sentinel, uint32_t index) {
+        uint32_t last = nodes[sentinel].prev;
+        nodes[index].prev = last;
+        nodes[index].next = sentinel;
+        nodes[last].next = index;
+        nodes[sentinel].prev = index;
+    }
+
+    void unlink(uint32_t index) {
+        Node& node = nodes[index];
+        nodes[node.prev].next = node.next;
+        nodes[node.next].prev = node.prev;
+        node.prev = node.next = index;
+    }
+
+    // move every node of `from` to the back of `to`
+    void splice(uint32_t from, uint32_t to) {
+        if (isEmpty(from)) {
+            return;
+        }
+        uint32_t first = nodes[from].next;
+        uint32_t last = nodes[from].prev;
+        uint32_t tail = nodes[to].prev;
+        nodes[tail].next = first;
+        nodes[first].prev = tail;
+        nodes[last].next = to;
+        nodes[to].prev = last;
+        nodes[from].next = nodes[from].prev = from;
+    }
+
+    void place(uint32_t index, bool cascading) {
+        uint64_t expires = nodes[index].expires;
+        // fresh timers that are already due fire on the next tick, cascaded
+        // timers may land on the tick being processed
+        uint64_t earliest = cascading ? current : current + 1;
+        if (expires < earliest) {
+            expires = earliest;
+        }
+        uint64_t delta = expires - current;
+        if (delta >= MAX_DELTA) {
+            expires = current + MAX_DELTA - 1;
+            delta = MAX_DELTA - 1;
+        }
+
+        uint32_t level = 0;
+        while (level + 1 < LEVELS &&
+               delta >= (1ull << (SLOT_BITS * (level + 1)))) {
+            level++;
+        }
+        uint32_t slot = (expires >> (SLOT_BITS * level)) & SLOT_MASK;
+        linkBack(level * SLOTS + slot, index);
+    }
+
+    void cascade(uint32_t level, uint32_t slot) {
+        uint32_t sentinel = level * SLOTS + slot;
+        while (!isEmpty(sentinel)) {
+            uint32_t index = nodes[sentinel].next;
+            unlink(index);
+            place(index, true);
+        }
+    }
+
+    uint32_t allocate() {
+        if (!freeNodes.empty()) {
+            uint32_t index = freeNodes.back();
+            freeNodes.pop_back();
+            return index;
+        }
+        nodes.emplace_back();
+        uint32_t index = static_cast<uint32_t>(nodes.size() - 1);
+        nodes[index].prev = nodes[index].next = index;
+        return index;
+    }
+
+    void release(uint32_t index) {
+        Node& node = nodes[index];
+        node.active = false;
+        node.generation++;
+        node.action = ActionT{};
+        freeNodes.push_back(index);
+        activeCount--;
+    }
+
+   public:
+    /**
+     * @brief Construct a new Timer Wheel
+     * @param now The current tick
+     * @param reserve The number of timers to make room for up front
+     */
+    explicit TimerWheel(uint64_t now = 0, size_t reserve = 0) : current(now) {
+        nodes.resize(FIRST_TIMER);
+        for (uint32_t i = 0; i < FIRST_TIMER; i++) {
+            nodes[i].prev = nodes[i].next = i;
+        }
+        nodes.reserve(FIRST_TIMER + reserve);
+        freeNodes.reserve(reserve);
+    }
+
+    /**
+     * @brief Schedule a timer
+     * @param expires The absolute tick at which the timer is due
+     * @param period Re-arm the timer every `period` ticks, 0 for a one shot
+     * @param action The data handed back when the timer expires
+     * @return TimerID_t The handle to cancel the timer with
+     */
+    TimerID_t schedule(uint64_t expires, uint64_t period, ActionT action) {
+        uint32_t index = allocate();
+        Node& node = nodes[index];
+        node.active = true;
+        node.expires = expires;
+        node.period = period;
+        node.action = std::move(action);
+        activeCount++;
+        place(index, false);
+        return makeID(index, node.generation);
+    }
+
+    /**
+     * @brief Cancel a pending timer
+     * @return true if the timer was still pending
+     */
+    bool cancel(TimerID_t id) {
+        uint32_t index = static_cast<uint32_t>(id);
+        uint32_t generation = static_cast<uint32_t>(id >> 32);
+        if (index < FIRST_TIMER || index >= nodes.size()) {
+            return false;
+        }
+        Node& node = nodes[index];
+        if (!node.active || node.generation != generation) {
+            return false;
+        }
+        unlink(index);
+        release(index);
+        return true;
+    }
+
+    /**
+     * @brief Advance the wheel to `now` and queue every timer due by then
+     * @return size_t The number of timers waiting in the expiring list
+     */
+    size_t collect(uint64_t now) {
+        if (activeCount == 0 && isEmpty(EXPIRING)) {
+            current = now > current ? now : current;
+            return 0;
+        }
+        while (current < now) {
+            current++;
+            uint32_t level = 0;
+            uint64_t tick = current;
+            // cascade the upper levels each time a lower level wraps around
+            while (level + 1 < LEVELS && (tick & SLOT_MASK) == 0) {
+                tick >>= SLOT_BITS;
+                level++;
+                cascade(level, tick & SLOT_MASK);
+            }
+            splice(current & SLOT_MASK, EXPIRING);
+        }
+
+        size_t expiring = 0;
+        for (uint32_t i = nodes[EXPIRING].next; i != EXPIRING;
+             i = nodes[i].next) {
+            expiring++;
+        }
+        return expiring;
+    }
+
+    /**
+     * @brief Take the next expired timer out of the expiring list
+     * @param action Receives the timer's action
+     * @param id Receives the timer's handle, if not null
+     * @return false once the expiring list is empty
+     * @note Periodic timers are re-armed before being handed out, so they can
+     * be cancelled from their own expiry handler
+     */
+    bool popExpired(ActionT& action, TimerID_t* id = nullptr) {
+        if (isEmpty(EXPIRING)) {
+            return false;
+        }
+        uint32_t index = nodes[EXPIRING].next;
+        Node& node = nodes[index];
+        unlink(index);
+        if (id) {
+            *id = makeID(index, node.generation);
+        }
+
+        if (node.period > 0) {
+            action = node.action;
+            uint64_t next = node.expires + node.period;
+            // coalesce missed periods instead of firing a burst
+            node.expires = next > current ? next : current + 1;
+            place(index, false);
+        } else {
+            action = std::move(node.action);
+            release(index);
+        }
+        return true;
+    }
+
+    uint64_t now() const {
+        return current;
+    }
+
+    size_t size() const {
+        return activeCount;
+    }
+
+    bool empty() const {
+        return activeCount == 0;
+    }
+};
+}  // namespace Helpers
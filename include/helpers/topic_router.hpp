@@ -0,0 +1,401 @@
+#pragma once
+#include <ArduinoJson.h>
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+#include "freertos/semphr.h"
+#include "message_buffer.hpp"
+
+namespace Helpers {
+
+/**
+ * @brief Routes JSON messages by topic into the `MessageBuffer`s subscribed
+ * to it
+ * @tparam EnumT The Enum Type for the Event
+ * @note Topic filters follow MQTT: levels are separated by `/`, `+` matches
+ * exactly one level and a trailing `#` matches the parent level and any
+ * number of levels below it. Wildcards in the first level do not match topics
+ * starting with `$`.
+ * @note All filters are compiled into one trie, so matching a topic costs
+ * O(depth) lookups plus the matching subscriptions, whatever the number of
+ * subscriptions.
+ * @note A buffer subscribed through several matching filters receives the
+ * message once. Delivery happens with the router unlocked, so observers may
+ * subscribe or unsubscribe from `update`.
+ * @note Buffers are held weakly and pinned while a message is delivered, so
+ * a buffer may be destroyed at any time. Destroyed buffers are skipped, their
+ * subscriptions stay until unsubscribed.
+ *
+ * @code
+ * ```
+ * Helpers::TopicRouter<EventID> router;
+ * router.subscribe("sensors/+/temperature", thermostat);  // shared_ptr
+ * router.subscribe("sensors/#", recorder);
+ *
+ * // pushed into both buffers
+ * router.route("sensors/kitchen/temperature", message);
+ * ```
+ */
+template <typename EnumT>
+class TopicRouter {
+   public:
+    using Buffer_t = MessageBuffer<EnumT>;
+    using BufferPtr_t = std::shared_ptr<Buffer_t>;
+    using SubscriptionID_t = uint64_t;
+    static constexpr SubscriptionID_t INVALID_SUBSCRIPTION = 0;
+
+   private:
+    static constexpr uint32_t NONE = UINT32_MAX;
+    static constexpr uint32_t ROOT = 0;
+
+    struct Node {
+        uint32_t parent = NONE;
+        std::string level;
+        std::map<std::string, uint32_t, std::less<> > children;
+        uint32_t plus = NONE;
+        uint32_t hash = NONE;
+        //* Indices into `targets`, one entry per subscription
+        std::vector<uint32_t> subscribers;
+    };
+
+    struct Target {
+        std::weak_ptr<Buffer_t> buffer;
+        uint32_t refs = 0;
+        uint64_t stamp = 0;
+    };
+
+    struct Route {
+        uint32_t node;
+        uint32_t target;
+    };
+
+    SemaphoreHandle_t mutex;
+    std::vector<Node> nodes;
+    std::vector<uint32_t> freeNodes;
+    std::vector<Target> targets;
+    std::vector<uint32_t> freeTargets;
+    //* By owner, so a destroyed buffer's address can be reused safely
+    std::map<std::weak_ptr<Buffer_t>, uint32_t, std::owner_less<> >
+        targetIndex;
+    std::unordered_map<SubscriptionID_t, Route> routes;
+    std::vector<std::string_view> levels;
+    SubscriptionID_t nextID = 1;
+    uint64_t stamp = 0;
+
+    static void split(std::string_view topic,
+                      std::vector<std::string_view>& out) {
+        out.clear();
+        size_t start = 0;
+        while (true) {
+            size_t end = topic.find('/', start);
+            if (end == std::string_view::npos) {
+                out.push_back(topic.substr(start));
+                return;
+            }
+            out.push_back(topic.substr(start, end - start));
+            start = end + 1;
+        }
+    }
+
+    uint32_t allocateNode(uint32_t parent, std::string_view level) {
+        uint32_t index;
+        if (!freeNodes.empty()) {
+            index = freeNodes.back();
+            freeNodes.pop_back();
+        } else {
+            nodes.emplace_back();
+            index = static_cast<uint32_t>(nodes.size() - 1);
+        }
+        nodes[index].parent = parent;
+        nodes[index].level = std::string(level);
+        return index;
+    }
+
+    uint32_t child(uint32_t parent, std::string_view level) {
+        uint32_t index;
+        if (level == "+") {
+            index = nodes[parent].plus;
+        } else if (level == "#") {
+            index = nodes[parent].hash;
+        } else {
+            auto found = nodes[parent].children.find(level);
+            index = found == nodes[parent].children.end() ? NONE
+                                                          : found->second;
+        }
+        if (index != NONE) {
+            return index;
+        }
+
+        // `nodes` may reallocate, look the parent up again afterwards
+        index = allocateNode(parent, level);
+        if (level == "+") {
+            nodes[parent].plus = index;
+        } else if (level == "#") {
+            nodes[parent].hash = index;
+        } else {
+            nodes[parent].children.emplace(std::string(level), index);
+        }
+        return index;
+    }
+
+    // release nodes that no longer lead to any subscription
+    void prune(uint32_t index) {
+        while (index != ROOT) {
+            Node& node = nodes[index];
+            if (!node.subscribers.empty() || !node.children.empty() ||
+                node.plus != NONE || node.hash != NONE) {
+                return;
+            }
+            Node& parent = nodes[node.parent];
+            if (node.level == "+") {
+                parent.plus = NONE;
+            } else if (node.level == "#") {
+                parent.hash = NONE;
+            } else {
+                parent.children.erase(node.level);
+            }
+            uint32_t next = node.parent;
+            node.parent = NONE;
+            node.level.clear();
+            freeNodes.push_back(index);
+            index = next;
+        }
+    }
+
+    uint32_t acquireTarget(const BufferPtr_t& buffer) {
+        auto found = targetIndex.find(buffer);
+        if (found != targetIndex.end()) {
+            targets[found->second].refs++;
+            return found->second;
+        }
+        uint32_t index;
+        if (!freeTargets.empty()) {
+            index = freeTargets.back();
+            freeTargets.pop_back();
+        } else {
+            targets.emplace_back();
+            index = static_cast<uint32_t>(targets.size() - 1);
+        }
+        targets[index] = {buffer, 1, 0};
+        targetIndex.emplace(buffer, index);
+        return index;
+    }
+
+    void releaseTarget(uint32_t index) {
+        if (--targets[index].refs > 0) {
+            return;
+        }
+        targetIndex.erase(targets[index].buffer);
+        targets[index].buffer.reset();
+        freeTargets.push_back(index);
+    }
+
+    void collect(const Node& node, std::vector<BufferPtr_t>& out) {
+        for (uint32_t index : node.subscribers) {
+            Target& target = targets[index];
+            if (target.stamp != stamp) {
+                target.stamp = stamp;
+                // pins the buffer until the caller is done with it
+                if (BufferPtr_t buffer = target.buffer.lock()) {
+                    out.push_back(std::move(buffer));
+                }
+            }
+        }
+    }
+
+    void match(uint32_t index, size_t depth, std::vector<BufferPtr_t>& out) {
+        const Node& node = nodes[index];
+        // wildcards in the first level skip `$` topics
+        bool wildcards = depth != 0 || levels[0].empty() ||
+                         levels[0].front() != '$';
+        if (wildcards && node.hash != NONE) {
+            collect(nodes[node.hash], out);
+        }
+        if (depth == levels.size()) {
+            collect(node, out);
+            return;
+        }
+        auto found = node.children.find(levels[depth]);
+        if (found != node.children.end()) {
+            match(found->second, depth + 1, out);
+        }
+        if (wildcards && node.plus != NONE) {
+            match(node.plus, depth + 1, out);
+        }
+    }
+
+   public:
+    TopicRouter() : mutex(xSemaphoreCreateMutex()) {
+        nodes.emplace_back();
+    }
+
+    virtual ~TopicRouter() {
+        vSemaphoreDelete(mutex);
+    }
+
+    TopicRouter(const TopicRouter&) = delete;
+    TopicRouter& operator=(const TopicRouter&) = delete;
+
+    /**
+     * @brief Check a topic filter, `+` and `#` must fill a whole level and
+     * `#` must be the last level
+     */
+    static bool validFilter(std::string_view filter) {
+        if (filter.empty()) {
+            return false;
+        }
+        for (size_t i = 0; i < filter.size(); i++) {
+            if (filter[i] != '+' && filter[i] != '#') {
+                continue;
+            }
+            bool levelStart = i == 0 || filter[i - 1] == '/';
+            bool levelEnd = i + 1 == filter.size() || filter[i + 1] == '/';
+            if (!levelStart || !levelEnd ||
+                (filter[i] == '#' && i + 1 != filter.size())) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    /**
+     * @brief Check a topic name, it must not contain wildcards
+     */
+    static bool validTopic(std::string_view topic) {
+        return !topic.empty() &&
+               topic.find_first_of("+#") == std::string_view::npos;
+    }
+
+    /**
+     * @brief Push the messages matching `filter` into `buffer`
+     * @return SubscriptionID_t The handle to unsubscribe with, or
+     * `INVALID_SUBSCRIPTION` if the filter is malformed or `buffer` empty
+     */
+    SubscriptionID_t subscribe(std::string_view filter,
+                               const BufferPtr_t& buffer) {
+        if (!buffer || !validFilter(filter)) {
+            return INVALID_SUBSCRIPTION;
+        }
+        xSemaphoreTake(mutex, portMAX_DELAY);
+        split(filter, levels);
+        uint32_t index = ROOT;
+        for (std::string_view level : levels) {
+            index = child(index, level);
+        }
+        uint32_t target = acquireTarget(buffer);
+        nodes[index].subscribers.push_back(target);
+        SubscriptionID_t id = nextID++;
+        routes.emplace(id, Route{index, target});
+        xSemaphoreGive(mutex);
+        return id;
+    }
+
+    /**
+     * @brief Remove a subscription
+     * @return true if the subscription existed
+     */
+    bool unsubscribe(SubscriptionID_t id) {
+        xSemaphoreTake(mutex, portMAX_DELAY);
+        auto found = routes.find(id);
+        if (found == routes.end()) {
+            xSemaphoreGive(mutex);
+            return false;
+        }
+        Route route = found->second;
+        routes.erase(found);
+        auto& subscribers = nodes[route.node].subscribers;
+        auto entry =
+            std::find(subscribers.begin(), subscribers.end(), route.target);
+        *entry = subscribers.back();
+        subscribers.pop_back();
+        releaseTarget(route.target);
+        prune(route.node);
+        xSemaphoreGive(mutex);
+        return true;
+    }
+
+    /**
+     * @brief Remove every subscription of a buffer
+     * @return size_t The number of subscriptions removed
+     */
+    size_t unsubscribeAll(const BufferPtr_t& buffer) {
+        std::vector<SubscriptionID_t> ids;
+        xSemaphoreTake(mutex, portMAX_DELAY);
+        auto target = targetIndex.find(buffer);
+        if (target != targetIndex.end()) {
+            for (auto& route : routes) {
+                if (route.second.target == target->second) {
+                    ids.push_back(route.first);
+                }
+            }
+        }
+        xSemaphoreGive(mutex);
+        for (SubscriptionID_t id : ids) {
+            unsubscribe(id);
+        }
+        return ids.size();
+    }
+
+    /**
+     * @brief Collect the live buffers subscribed to a topic, each one once
+     * @return size_t The number of buffers added to `out`
+     */
+    size_t match(std::string_view topic, std::vector<BufferPtr_t>& out) {
+        if (!validTopic(topic)) {
+            return 0;
+        }
+        size_t before = out.size();
+        xSemaphoreTake(mutex, portMAX_DELAY);
+        split(topic, levels);
+        stamp++;
+        match(ROOT, 0, out);
+        xSemaphoreGive(mutex);
+        return out.size() - before;
+    }
+
+    /**
+     * @brief Push a copy of `message` into every buffer subscribed to
+     * `topic`, notifying each buffer's observers
+     * @return size_t The number of buffers the message was delivered to
+     */
+    size_t route(std::string_view topic, const JsonDocument& message) {
+        std::vector<BufferPtr_t> matched;
+        match(topic, matched);
+        for (const BufferPtr_t& buffer : matched) {
+            buffer->addMessage(message);
+        }
+        return matched.size();
+    }
+
+    /**
+     * @brief Route a message by the topic stored in one of its fields
+     * @param topicKey The field holding the topic
+     * @return size_t The number of buffers the message was delivered to, 0 if
+     * the field is missing
+     */
+    size_t route(const JsonDocument& message, const char* topicKey = "topic") {
+        const char* topic = message[topicKey].as<const char*>();
+        if (!topic) {
+            return 0;
+        }
+        return route(std::string_view(topic), message);
+    }
+
+    /**
+     * @brief The number of subscriptions
+     */
+    size_t size() {
+        xSemaphoreTake(mutex, portMAX_DELAY);
+        size_t count = routes.size();
+        xSemaphoreGive(mutex);
+        return count;
+    }
+};
+}  // namespace Helpers
@@ -1,5 +1,8 @@
 #pragma once
 #include <string>
+#include <type_traits>
+#include <utility>
+#include <variant>
 #include "id_interface.hpp"
 
 namespace Helpers {
@@ -21,4 +24,94 @@ class VisitorBase : public VisitorRoot, public IId {
     virtual void visit(IElement* element) = 0;
 };
 
+/**
+ * @brief Build a visitor out of a set of lambdas, one per element type
+ *
+ * @code
+ * ```
+ * auto visitor = Helpers::Overloaded{
+ *     [](Sensor& sensor) { ... },
+ *     [](Actuator& actuator) { ... },
+ * };
+ * ```
+ */
+template <typename... Fs>
+struct Overloaded : Fs... {
+    using Fs::operator()...;
+};
+template <typename... Fs>
+Overloaded(Fs...) -> Overloaded<Fs...>;
+
+/**
+ * @brief An element of a closed set of element types
+ * @note Visiting through `std::visit` dispatches with a jump table, no
+ * virtual call or RTTI is involved
+ */
+template <typename... Elements>
+using ElementVariant = std::variant<Elements...>;
+
+/**
+ * @brief Element base with compile-time double dispatch
+ * @tparam Derived The concrete element type (CRTP)
+ * @note `accept(visitor)` with a concrete visitor resolves the overload at
+ * compile time. The `IElement` interface is kept so the element can still be
+ * stored and visited in open sets through `VisitorBase`.
+ *
+ * @code
+ * ```
+ * class Sensor : public Helpers::Element<Sensor> {};
+ *
+ * Sensor sensor;
+ * sensor.accept(Helpers::Overloaded{[](Sensor& sensor) { ... }});
+ * ```
+ */
+template <typename Derived>
+class Element : public IElement {
+   public:
+    template <typename Visitor,
+              typename = typename std::enable_if<!std::is_pointer<
+                  typename std::decay<Visitor>::type>::value>::type>
+    void accept(Visitor&& visitor) {
+        visitor(static_cast<Derived&>(*this));
+    }
+
+    void accept(VisitorRoot* visitor) override {
+        auto* visitorBase = dynamic_cast<VisitorBase*>(visitor);
+        if (visitorBase) {
+            visitorBase->visit(this);
+        }
+    }
+};
+
+/**
+ * @brief Visit a single element of a closed set
+ */
+template <typename Visitor, typename... Elements>
+decltype(auto) visit(ElementVariant<Elements...>& element, Visitor&& visitor) {
+    return std::visit(std::forward<Visitor>(visitor), element);
+}
+
+/**
+ * @brief Visit every element of a range of `ElementVariant`
+ * @param elements Any iterable of `ElementVariant`, e.g. a `std::vector`
+ * @param visitor A callable accepting every element type of the variant
+ */
+template <typename Range, typename Visitor>
+void visitEach(Range& elements, Visitor&& visitor) {
+    for (auto& element : elements) {
+        std::visit(visitor, element);
+    }
+}
+
+/**
+ * @brief Visit a closed-set element with an open-set visitor
+ * @note Every alternative must derive from `IElement`
+ */
+template <typename... Elements>
+void accept(ElementVariant<Elements...>& element, VisitorRoot* visitor) {
+    std::visit(
+        [visitor](IElement& alternative) { alternative.accept(visitor); },
+        element);
+}
+
 }  // namespace Helpers
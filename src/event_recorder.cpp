@@ -0,0 +1,178 @@
+#include <helpers/event_recorder.hpp>
+#include <chrono>
+#include <cstring>
+#include <thread>
+
+namespace {
+thread_local unsigned suppressDepth = 0;
+
+//* An encoded record is never larger than this, guards against corrupt input
+constexpr uint64_t MAX_RECORD_SIZE = 16 * 1024 * 1024;
+
+void writeVarint(std::ostream& out, uint64_t value, uint64_t& bytes) {
+    char encoded[10];
+    size_t length = 0;
+    while (value >= 0x80) {
+        encoded[length++] = static_cast<char>(value | 0x80);
+        value >>= 7;
+    }
+    encoded[length++] = static_cast<char>(value);
+    out.write(encoded, length);
+    bytes += length;
+}
+
+bool readVarint(std::istream& in, uint64_t& value) {
+    value = 0;
+    for (uint32_t shift = 0; shift < 64; shift += 7) {
+        int next = in.get();
+        if (next == std::char_traits<char>::eof()) {
+            return false;
+        }
+        value |= static_cast<uint64_t>(next & 0x7f) << shift;
+        if (!(next & 0x80)) {
+            return true;
+        }
+    }
+    return false;
+}
+}  // namespace
+
+Helpers::EventRecorder::Suppress::Suppress() {
+    suppressDepth++;
+}
+
+Helpers::EventRecorder::Suppress::~Suppress() {
+    suppressDepth--;
+}
+
+bool Helpers::EventRecorder::suppressed() {
+    return suppressDepth > 0;
+}
+
+uint64_t Helpers::EventRecorder::steadyMicros() {
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+               std::chrono::steady_clock::now().time_since_epoch())
+        .count();
+}
+
+Helpers::EventRecorder::EventRecorder(std::ostream& out, Clock_t clock)
+    : mutex(xSemaphoreCreateMutex()),
+      out(&out),
+      clock(std::move(clock)),
+      lastTime(this->clock()) {
+    writeHeader();
+}
+
+Helpers::EventRecorder::EventRecorder(const std::string& path, Clock_t clock)
+    : mutex(xSemaphoreCreateMutex()),
+      file(new std::ofstream(path, std::ios::binary | std::ios::trunc)),
+      out(file.get()),
+      clock(std::move(clock)),
+      lastTime(this->clock()) {
+    writeHeader();
+}
+
+Helpers::EventRecorder::Active::Active()
+    : recorder(activeRecorder.load(std::memory_order_acquire)) {
+    if (!recorder || suppressed()) {
+        recorder = nullptr;
+        return;
+    }
+    // announce the hook, then read the recorder again: either the destructor
+    // sees the count, or this sees the recorder deactivated
+    inFlight.fetch_add(1);
+    recorder = activeRecorder.load();
+    if (!recorder) {
+        inFlight.fetch_sub(1);
+    }
+}
+
+Helpers::EventRecorder::Active::~Active() {
+    if (recorder) {
+        inFlight.fetch_sub(1, std::memory_order_release);
+    }
+}
+
+Helpers::EventRecorder::~EventRecorder() {
+    // stop the hooks from reaching a destroyed recorder, and wait for those
+    // that already have
+    EventRecorder* self = this;
+    activeRecorder.compare_exchange_strong(self, nullptr);
+    while (inFlight.load() != 0) {
+        std::this_thread::yield();
+    }
+    flush();
+    vSemaphoreDelete(mutex);
+}
+
+void Helpers::EventRecorder::writeHeader() {
+    out->write(MAGIC, sizeof(MAGIC));
+    out->put(static_cast<char>(VERSION));
+    byteCount += sizeof(MAGIC) + 1;
+}
+
+void Helpers::EventRecorder::record(RecordType_e type, uint64_t subject,
+                                    uint64_t key, int64_t event,
+                                    const char* payload, size_t length) {
+    xSemaphoreTake(mutex, portMAX_DELAY);
+    // the clock is read under the lock, so deltas are never negative
+    uint64_t now = clock();
+    scratch.type = type;
+    scratch.time = now > lastTime ? now - lastTime : 0;
+    scratch.subject = subject;
+    scratch.key = key;
+    scratch.event = event;
+    scratch.payload.assign(payload ? payload : "", payload ? length : 0);
+    lastTime = now > lastTime ? now : lastTime;
+
+    encodeMessage(scratch, encoded);
+    writeVarint(*out, encoded.size(), byteCount);
+    out->write(reinterpret_cast<const char*>(encoded.data()), encoded.size());
+    byteCount += encoded.size();
+    recordCount++;
+    xSemaphoreGive(mutex);
+}
+
+void Helpers::EventRecorder::flush() {
+    xSemaphoreTake(mutex, portMAX_DELAY);
+    out->flush();
+    xSemaphoreGive(mutex);
+}
+
+Helpers::RecordingReader::RecordingReader(std::istream& in) : in(&in) {
+    readHeader();
+}
+
+Helpers::RecordingReader::RecordingReader(const std::string& path)
+    : file(new std::ifstream(path, std::ios::binary)), in(file.get()) {
+    readHeader();
+}
+
+void Helpers::RecordingReader::readHeader() {
+    char magic[sizeof(EventRecorder::MAGIC)];
+    if (!in->read(magic, sizeof(magic)) ||
+        std::memcmp(magic, EventRecorder::MAGIC, sizeof(magic)) != 0) {
+        return;
+    }
+    valid = in->get() == EventRecorder::VERSION;
+}
+
+bool Helpers::RecordingReader::next(RecordedEvent& record) {
+    uint64_t length;
+    if (!valid || !readVarint(*in, length)) {
+        return false;
+    }
+    if (length > MAX_RECORD_SIZE) {
+        valid = false;
+        return false;
+    }
+    encoded.resize(length);
+    if (!in->read(reinterpret_cast<char*>(encoded.data()), length) ||
+        !decodeMessage(encoded.data(), encoded.size(), record)) {
+        valid = false;
+        return false;
+    }
+    time += record.time;
+    record.time = time;
+    return true;
+}
@@ -1,4 +1,5 @@
 #include <helpers/helpers.hpp>
+#include <helpers/progress.hpp>
 
 char* Helpers::itoa(int value, char* result, int base) {
     // check that the base if valid
@@ -95,18 +96,15 @@ char* Helpers::StringtoChar(const std::string& inputString) {
 } */
 
 void Helpers::update_progress_bar(int progress, int total) {
-    int barWidth = 70;
-
-    std::cout << "\r[";
-    int pos = barWidth * progress / total;
-    for (int i = 0; i < barWidth; ++i) {
-        if (i < pos)
-            std::cout << "=";
-        else if (i == pos)
-            std::cout << ">";
-        else
-            std::cout << " ";
-    }
-    std::cout << "] " << int(progress * 100.0 / total) << " %\r";
+    // negative counts would wrap around as unsigned
+    progress = progress > 0 ? progress : 0;
+    total = total > 0 ? total : 0;
+    // build the whole line first so that it goes out in a single write
+    std::string line = "\r";
+    appendProgressBar(line, progress, total, 70);
+    line += ' ';
+    line += std::to_string(total ? int(progress * 100.0 / total) : 0);
+    line += " %\r";
+    std::cout.write(line.data(), line.size());
     std::cout.flush();
 }
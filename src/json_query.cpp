@@ -0,0 +1,490 @@
+#include <helpers/json_query.hpp>
+#include <cctype>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+
+//* Recursive descent over the expression, building the AST and path trie
+class Helpers::JsonQuery::Parser {
+    const std::string& text;
+    size_t position = 0;
+    JsonQuery& query;
+
+    bool fail(const char* message) {
+        if (query.error.empty()) {
+            query.error = message;
+            query.errorOffset = position;
+        }
+        return false;
+    }
+
+    void skipSpaces() {
+        while (position < text.size() &&
+               std::isspace(static_cast<unsigned char>(text[position]))) {
+            position++;
+        }
+    }
+
+    bool consume(const char* token) {
+        skipSpaces();
+        size_t length = std::strlen(token);
+        if (text.compare(position, length, token) == 0) {
+            position += length;
+            return true;
+        }
+        return false;
+    }
+
+    bool peek(char c) {
+        skipSpaces();
+        return position < text.size() && text[position] == c;
+    }
+
+    static bool identStart(char c) {
+        return std::isalpha(static_cast<unsigned char>(c)) || c == '_';
+    }
+
+    static bool identChar(char c) {
+        return std::isalnum(static_cast<unsigned char>(c)) || c == '_' ||
+               c == '-';
+    }
+
+    uint32_t addNode(Node node) {
+        query.nodes.push_back(std::move(node));
+        return query.nodes.size() - 1;
+    }
+
+    // find or create the child of `parent` for a key, index or wildcard
+    uint32_t child(uint32_t parent, const std::string* key, int32_t index) {
+        if (key) {
+            for (uint32_t next : query.trie[parent].keys) {
+                if (query.trie[next].key == *key) {
+                    return next;
+                }
+            }
+        } else if (index >= 0) {
+            for (uint32_t next : query.trie[parent].indices) {
+                if (query.trie[next].index == index) {
+                    return next;
+                }
+            }
+        } else if (query.trie[parent].wildcard) {
+            return query.trie[parent].wildcard;
+        }
+
+        uint32_t next = query.trie.size();
+        query.trie.emplace_back();
+        if (key) {
+            query.trie[next].key = *key;
+            query.trie[parent].keys.push_back(next);
+        } else if (index >= 0) {
+            query.trie[next].index = index;
+            query.trie[parent].indices.push_back(next);
+        } else {
+            query.trie[parent].wildcard = next;
+        }
+        return next;
+    }
+
+    bool parseString(std::string& out) {
+        char quote = text[position++];
+        while (position < text.size() && text[position] != quote) {
+            char c = text[position++];
+            if (c == '\\' && position < text.size()) {
+                c = text[position++];
+                c = c == 'n' ? '\n' : c == 't' ? '\t' : c;
+            }
+            out.push_back(c);
+        }
+        if (position >= text.size()) {
+            return fail("Unterminated string");
+        }
+        position++;
+        return true;
+    }
+
+    bool parseBracket(uint32_t& node) {
+        skipSpaces();
+        if (position >= text.size()) {
+            return fail("Expected an index, * or a key");
+        }
+        char c = text[position];
+        if (c == '*') {
+            position++;
+            node = child(node, nullptr, -1);
+        } else if (c == '"' || c == '\'') {
+            std::string key;
+            if (!parseString(key)) {
+                return false;
+            }
+            node = child(node, &key, -1);
+        } else if (std::isdigit(static_cast<unsigned char>(c))) {
+            int32_t index = 0;
+            while (position < text.size() &&
+                   std::isdigit(static_cast<unsigned char>(text[position]))) {
+                int digit = text[position] - '0';
+                if (index > (INT32_MAX - digit) / 10) {
+                    return fail("Index too large");
+                }
+                index = index * 10 + digit;
+                position++;
+            }
+            node = child(node, nullptr, index);
+        } else {
+            return fail("Expected an index, * or a key");
+        }
+        return consume("]") || fail("Expected ]");
+    }
+
+    bool parseSegment(uint32_t& node) {
+        if (position < text.size() && text[position] == '*') {
+            position++;
+            node = child(node, nullptr, -1);
+            return true;
+        }
+        if (position >= text.size() || !identStart(text[position])) {
+            return fail("Expected a key");
+        }
+        size_t start = position;
+        while (position < text.size() && identChar(text[position])) {
+            position++;
+        }
+        std::string key = text.substr(start, position - start);
+        node = child(node, &key, -1);
+        return true;
+    }
+
+    bool parsePath(uint32_t& path) {
+        skipSpaces();
+        uint32_t node = 0;
+        if (position < text.size() && text[position] == '$') {
+            position++;
+        } else if ((position >= text.size() || text[position] != '[') &&
+                   !parseSegment(node)) {
+            return false;
+        }
+        while (position < text.size()) {
+            if (text[position] == '.') {
+                position++;
+                if (!parseSegment(node)) {
+                    return false;
+                }
+            } else if (text[position] == '[') {
+                position++;
+                if (!parseBracket(node)) {
+                    return false;
+                }
+            } else {
+                break;
+            }
+        }
+
+        // identical paths share their bindings
+        PathNode& end = query.trie[node];
+        if (end.paths.empty()) {
+            end.paths.push_back(query.bindings.size());
+            query.bindings.emplace_back();
+        }
+        path = end.paths.front();
+        return true;
+    }
+
+    bool parseLiteral(Literal& literal) {
+        skipSpaces();
+        if (position >= text.size()) {
+            return fail("Expected a value");
+        }
+        char c = text[position];
+        if (c == '"' || c == '\'') {
+            literal.type = STRING;
+            return parseString(literal.text);
+        }
+        if (consume("true")) {
+            literal.type = BOOLEAN;
+            literal.flag = true;
+            return true;
+        }
+        if (consume("false")) {
+            literal.type = BOOLEAN;
+            literal.flag = false;
+            return true;
+        }
+        if (consume("null")) {
+            literal.type = NONE;
+            return true;
+        }
+        const char* start = text.c_str() + position;
+        char* end = nullptr;
+        literal.number = std::strtod(start, &end);
+        if (end == start) {
+            return fail("Expected a value");
+        }
+        literal.type = NUMBER;
+        position += end - start;
+        return true;
+    }
+
+    bool parseComparison(uint32_t& node) {
+        Node compare;
+        if (!parsePath(compare.path)) {
+            return false;
+        }
+        static const struct {
+            const char* token;
+            Op_e op;
+        } operators[] = {{"==", EQ}, {"!=", NE}, {"<=", LE},
+                         {">=", GE}, {"<", LT},  {">", GT}};
+        for (const auto& candidate : operators) {
+            if (consume(candidate.token)) {
+                compare.kind = COMPARE;
+                compare.op = candidate.op;
+                if (!parseLiteral(compare.literal)) {
+                    return false;
+                }
+                break;
+            }
+        }
+        node = addNode(std::move(compare));
+        return true;
+    }
+
+    bool parseUnary(uint32_t& node) {
+        if (peek('!') && text.compare(position, 2, "!=") != 0) {
+            position++;
+            uint32_t operand;
+            if (!parseUnary(operand)) {
+                return false;
+            }
+            Node negate;
+            negate.kind = NOT;
+            negate.left = operand;
+            node = addNode(negate);
+            return true;
+        }
+        if (consume("(")) {
+            return parseOr(node) && (consume(")") || fail("Expected )"));
+        }
+        return parseComparison(node);
+    }
+
+    bool parseAnd(uint32_t& node) {
+        if (!parseUnary(node)) {
+            return false;
+        }
+        while (consume("&&")) {
+            Node both;
+            both.kind = AND;
+            both.left = node;
+            if (!parseUnary(both.right)) {
+                return false;
+            }
+            node = addNode(both);
+        }
+        return true;
+    }
+
+    bool parseOr(uint32_t& node) {
+        if (!parseAnd(node)) {
+            return false;
+        }
+        while (consume("||")) {
+            Node either;
+            either.kind = OR;
+            either.left = node;
+            if (!parseAnd(either.right)) {
+                return false;
+            }
+            node = addNode(either);
+        }
+        return true;
+    }
+
+   public:
+    Parser(const std::string& text, JsonQuery& query)
+        : text(text), query(query) {}
+
+    bool parse() {
+        if (!parseOr(query.root)) {
+            return false;
+        }
+        skipSpaces();
+        return position == text.size() || fail("Unexpected character");
+    }
+};
+
+Helpers::JsonQuery::JsonQuery(const std::string& expression) : trie(1) {
+    Parser(expression, *this).parse();
+}
+
+void Helpers::JsonQuery::bind(uint32_t index, JsonVariantConst value) {
+    const PathNode& node = trie[index];
+    for (uint32_t path : node.paths) {
+        bindings[path].push_back(value);
+    }
+
+    if (!node.keys.empty() && value.is<JsonObjectConst>()) {
+        // one pass over the members for every key wanted at this level
+        size_t found = 0;
+        for (JsonPairConst member : value.as<JsonObjectConst>()) {
+            JsonString key = member.key();
+            size_t length = key.size();
+            for (uint32_t next : node.keys) {
+                const std::string& wanted = trie[next].key;
+                if (wanted.size() == length &&
+                    std::memcmp(wanted.data(), key.c_str(), length) == 0) {
+                    bind(next, member.value());
+                    found++;
+                    break;
+                }
+            }
+            if (found == node.keys.size()) {
+                break;
+            }
+        }
+    }
+
+    if (!node.indices.empty() && value.is<JsonArrayConst>()) {
+        JsonArrayConst array = value.as<JsonArrayConst>();
+        size_t size = array.size();
+        for (uint32_t next : node.indices) {
+            if (static_cast<size_t>(trie[next].index) < size) {
+                bind(next, array[trie[next].index]);
+            }
+        }
+    }
+
+    if (node.wildcard) {
+        if (value.is<JsonArrayConst>()) {
+            for (JsonVariantConst element : value.as<JsonArrayConst>()) {
+                bind(node.wildcard, element);
+            }
+        } else if (value.is<JsonObjectConst>()) {
+            for (JsonPairConst member : value.as<JsonObjectConst>()) {
+                bind(node.wildcard, member.value());
+            }
+        }
+    }
+}
+
+void Helpers::JsonQuery::resolve(JsonVariantConst message) {
+    // cleared, not freed, so a batch reuses the same storage
+    for (auto& values : bindings) {
+        values.clear();
+    }
+    bind(0, message);
+}
+
+bool Helpers::JsonQuery::truthy(JsonVariantConst value) {
+    return !value.isNull() && !(value.is<bool>() && !value.as<bool>());
+}
+
+bool Helpers::JsonQuery::compare(JsonVariantConst value, Op_e op,
+                                 const Literal& literal) {
+    int order;
+    switch (literal.type) {
+        case NUMBER: {
+            if (!value.is<double>()) {
+                return op == NE;
+            }
+            double number = value.as<double>();
+            order = number < literal.number ? -1 : number > literal.number;
+            break;
+        }
+        case STRING:
+            if (!value.is<const char*>()) {
+                return op == NE;
+            }
+            order = std::strcmp(value.as<const char*>(), literal.text.c_str());
+            break;
+        case BOOLEAN:
+            if (!value.is<bool>()) {
+                return op == NE;
+            }
+            order = value.as<bool>() == literal.flag ? 0 : 2;
+            break;
+        default:
+            order = value.isNull() ? 0 : 2;
+            break;
+    }
+
+    // 2 marks values that are unequal but not ordered
+    switch (op) {
+        case EQ:
+            return order == 0;
+        case NE:
+            return order != 0;
+        case LT:
+            return order == -1;
+        case LE:
+            return order == -1 || order == 0;
+        case GT:
+            return order == 1;
+        case GE:
+            return order == 1 || order == 0;
+    }
+    return false;
+}
+
+bool Helpers::JsonQuery::evaluate(uint32_t index) const {
+    const Node& node = nodes[index];
+    switch (node.kind) {
+        case OR:
+            return evaluate(node.left) || evaluate(node.right);
+        case AND:
+            return evaluate(node.left) && evaluate(node.right);
+        case NOT:
+            return !evaluate(node.left);
+        case COMPARE: {
+            const auto& values = bindings[node.path];
+            if (values.empty()) {
+                // a missing value reads as null
+                return compare(JsonVariantConst(), node.op, node.literal);
+            }
+            for (JsonVariantConst value : values) {
+                if (compare(value, node.op, node.literal)) {
+                    return true;
+                }
+            }
+            return false;
+        }
+        case EXISTS:
+            for (JsonVariantConst value : bindings[node.path]) {
+                if (truthy(value)) {
+                    return true;
+                }
+            }
+            return false;
+    }
+    return false;
+}
+
+void Helpers::JsonQuery::selected(std::vector<JsonVariantConst>& out) const {
+    const Node& node = nodes[root];
+    if (node.kind == EXISTS) {
+        const auto& values = bindings[node.path];
+        out.insert(out.end(), values.begin(), values.end());
+    } else if (node.kind == COMPARE) {
+        for (JsonVariantConst value : bindings[node.path]) {
+            if (compare(value, node.op, node.literal)) {
+                out.push_back(value);
+            }
+        }
+    }
+}
+
+bool Helpers::JsonQuery::matches(JsonVariantConst message) {
+    if (!valid()) {
+        return false;
+    }
+    resolve(message);
+    return evaluate(root);
+}
+
+void Helpers::JsonQuery::select(JsonVariantConst message,
+                                std::vector<JsonVariantConst>& out) {
+    if (!valid()) {
+        return;
+    }
+    resolve(message);
+    selected(out);
+}
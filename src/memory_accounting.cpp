@@ -0,0 +1,398 @@
+#include <helpers/memory_accounting.hpp>
+#include <cstdio>
+#include <cstdint>
+#include <cstdlib>
+#include <map>
+#include <memory>
+#include <new>
+#include <utility>
+#include "freertos/semphr.h"
+
+namespace {
+thread_local Helpers::MemoryAccount* currentAccount = nullptr;
+
+//* Prepended to every accounted block
+struct alignas(alignof(std::max_align_t)) BlockHeader {
+    Helpers::MemoryAccount* account;
+    size_t size;
+};
+
+//* Prepended to over-aligned blocks, which also keep the start of the block
+struct AlignedHeader {
+    void* base;
+    BlockHeader block;
+};
+
+// Accounts are never destroyed, blocks may still be freed by static
+// destructors. The root accounts may also be reached from operator new during
+// static initialization, so their construction must not allocate.
+template <typename T>
+class Immortal {
+    alignas(T) unsigned char storage[sizeof(T)];
+
+   public:
+    template <typename... Args>
+    explicit Immortal(Args&&... args) {
+        new (storage) T(std::forward<Args>(args)...);
+    }
+
+    T& get() {
+        return *reinterpret_cast<T*>(storage);
+    }
+};
+
+Helpers::MemoryAccount& unattributed() {
+    static Immortal<Helpers::MemoryAccount> account("Unattributed", "",
+                                                    &Helpers::memoryTotal());
+    return account.get();
+}
+
+//* The registry's own bookkeeping
+Helpers::MemoryAccount& accountingOverhead() {
+    static Immortal<Helpers::MemoryAccount> account("Accounting", "",
+                                                    &Helpers::memoryTotal());
+    return account.get();
+}
+
+struct Registry {
+    SemaphoreHandle_t mutex = xSemaphoreCreateMutex();
+    std::map<std::string, std::unique_ptr<Helpers::MemoryAccount> >
+        subsystems;
+    std::map<std::pair<std::string, std::string>,
+             std::unique_ptr<Helpers::MemoryAccount> >
+        instances;
+};
+
+Registry& registry() {
+    static Immortal<Registry> registry;
+    return registry.get();
+}
+
+Helpers::MemoryAccount& findSubsystem(Registry& accounts,
+                                      const std::string& subsystem) {
+    auto& account = accounts.subsystems[subsystem];
+    if (!account) {
+        account.reset(new Helpers::MemoryAccount(subsystem, "",
+                                                 &Helpers::memoryTotal()));
+    }
+    return *account;
+}
+
+Helpers::MemoryUsage snapshot(const Helpers::MemoryAccount& account) {
+    return {account.getSubsystem(),    account.getInstance(),
+            account.getCurrentBytes(), account.getPeakBytes(),
+            account.getAllocations(),  account.getDeallocations()};
+}
+
+void writeUsage(JsonObject object, const Helpers::MemoryAccount& account) {
+    object["current"] = account.getCurrentBytes();
+    object["peak"] = account.getPeakBytes();
+    object["allocations"] = account.getAllocations();
+    object["deallocations"] = account.getDeallocations();
+}
+
+// collect the accounts under the registry lock, so the caller can allocate
+// its output without holding it
+std::vector<Helpers::MemoryAccount*> collectAccounts() {
+    std::vector<Helpers::MemoryAccount*> accounts;
+    Registry& accountsRegistry = registry();
+    Helpers::MemoryScope overhead(accountingOverhead());
+    xSemaphoreTake(accountsRegistry.mutex, portMAX_DELAY);
+    accounts.reserve(accountsRegistry.subsystems.size() +
+                     accountsRegistry.instances.size() + 3);
+    accounts.push_back(&Helpers::memoryTotal());
+    accounts.push_back(&unattributed());
+    accounts.push_back(&accountingOverhead());
+    for (auto& subsystem : accountsRegistry.subsystems) {
+        accounts.push_back(subsystem.second.get());
+        auto instance = accountsRegistry.instances.lower_bound(
+            std::make_pair(subsystem.first, std::string()));
+        for (; instance != accountsRegistry.instances.end() &&
+               instance->first.first == subsystem.first;
+             ++instance) {
+            accounts.push_back(instance->second.get());
+        }
+    }
+    xSemaphoreGive(accountsRegistry.mutex);
+    return accounts;
+}
+
+class AccountedJsonAllocator : public ArduinoJson::Allocator {
+   public:
+    void* allocate(size_t size) override {
+        return Helpers::accountedAllocate(size);
+    }
+    void deallocate(void* pointer) override {
+        Helpers::accountedFree(pointer);
+    }
+    void* reallocate(void* pointer, size_t size) override {
+        return Helpers::accountedReallocate(pointer, size);
+    }
+};
+}  // namespace
+
+Helpers::MemoryAccount& Helpers::memoryTotal() {
+    static Immortal<MemoryAccount> account("", "", nullptr);
+    return account.get();
+}
+
+Helpers::MemoryAccount& Helpers::memoryAccount(const std::string& subsystem) {
+    Registry& accounts = registry();
+    MemoryScope overhead(accountingOverhead());
+    xSemaphoreTake(accounts.mutex, portMAX_DELAY);
+    MemoryAccount& account = findSubsystem(accounts, subsystem);
+    xSemaphoreGive(accounts.mutex);
+    return account;
+}
+
+Helpers::MemoryAccount& Helpers::memoryAccount(const std::string& subsystem,
+                                               const std::string& instance) {
+    Registry& accounts = registry();
+    MemoryScope overhead(accountingOverhead());
+    xSemaphoreTake(accounts.mutex, portMAX_DELAY);
+    auto& account = accounts.instances[std::make_pair(subsystem, instance)];
+    if (!account) {
+        account.reset(new MemoryAccount(subsystem, instance,
+                                        &findSubsystem(accounts, subsystem)));
+    }
+    xSemaphoreGive(accounts.mutex);
+    return *account;
+}
+
+std::string Helpers::memoryInstance(const void* self, const IId* id) {
+    if (id) {
+        return std::to_string(id->getID());
+    }
+    char address[2 * sizeof(void*) + 3];
+    snprintf(address, sizeof(address), "%p", self);
+    return address;
+}
+
+std::vector<Helpers::MemoryUsage> Helpers::memoryUsage() {
+    std::vector<MemoryUsage> usage;
+    for (MemoryAccount* account : collectAccounts()) {
+        usage.push_back(snapshot(*account));
+    }
+    return usage;
+}
+
+void Helpers::memoryUsageJson(JsonDocument& doc) {
+    std::vector<MemoryAccount*> accounts = collectAccounts();
+    writeUsage(doc.to<JsonObject>(), memoryTotal());
+    JsonObject subsystems = doc["subsystems"].to<JsonObject>();
+    for (MemoryAccount* account : accounts) {
+        if (account == &memoryTotal()) {
+            continue;
+        }
+        const char* subsystem = account->getSubsystem().c_str();
+        const char* instance = account->getInstance().c_str();
+        if (!*instance) {
+            writeUsage(subsystems[subsystem].to<JsonObject>(), *account);
+        } else {
+            writeUsage(
+                subsystems[subsystem]["instances"][instance].to<JsonObject>(),
+                *account);
+        }
+    }
+}
+
+void Helpers::resetMemoryPeaks() {
+    for (MemoryAccount* account : collectAccounts()) {
+        account->resetPeak();
+    }
+}
+
+void* Helpers::accountedAllocate(size_t size) {
+    MemoryAccount* account = currentAccount ? currentAccount : &unattributed();
+    BlockHeader* header =
+        static_cast<BlockHeader*>(std::malloc(sizeof(BlockHeader) + size));
+    if (!header) {
+        return nullptr;
+    }
+    header->account = account;
+    header->size = size;
+    account->allocated(size);
+    return header + 1;
+}
+
+void Helpers::accountedFree(void* block) {
+    if (!block) {
+        return;
+    }
+    BlockHeader* header = static_cast<BlockHeader*>(block) - 1;
+    header->account->released(header->size);
+    std::free(header);
+}
+
+void* Helpers::accountedAllocateAligned(size_t size, size_t alignment) {
+    MemoryAccount* account = currentAccount ? currentAccount : &unattributed();
+    alignment = alignment > alignof(AlignedHeader) ? alignment
+                                                   : alignof(AlignedHeader);
+    uint8_t* base = static_cast<uint8_t*>(
+        std::malloc(sizeof(AlignedHeader) + alignment - 1 + size));
+    if (!base) {
+        return nullptr;
+    }
+    uintptr_t start = reinterpret_cast<uintptr_t>(base + sizeof(AlignedHeader));
+    uint8_t* block = reinterpret_cast<uint8_t*>(
+        (start + alignment - 1) & ~uintptr_t(alignment - 1));
+    AlignedHeader* header = reinterpret_cast<AlignedHeader*>(block) - 1;
+    header->base = base;
+    header->block.account = account;
+    header->block.size = size;
+    account->allocated(size);
+    return block;
+}
+
+void Helpers::accountedFreeAligned(void* block) {
+    if (!block) {
+        return;
+    }
+    AlignedHeader* header = static_cast<AlignedHeader*>(block) - 1;
+    header->block.account->released(header->block.size);
+    std::free(header->base);
+}
+
+void* Helpers::accountedReallocate(void* block, size_t size) {
+    if (!block) {
+        return accountedAllocate(size);
+    }
+    // a resized block stays with the account it was charged to
+    BlockHeader* header = static_cast<BlockHeader*>(block) - 1;
+    MemoryAccount* account = header->account;
+    size_t previous = header->size;
+    BlockHeader* resized = static_cast<BlockHeader*>(
+        std::realloc(header, sizeof(BlockHeader) + size));
+    if (!resized) {
+        return nullptr;
+    }
+    account->released(previous);
+    account->allocated(size);
+    resized->size = size;
+    return resized + 1;
+}
+
+ArduinoJson::Allocator* Helpers::accountedJsonAllocator() {
+    static AccountedJsonAllocator allocator;
+    return &allocator;
+}
+
+Helpers::MemoryScope::MemoryScope(MemoryAccount& account)
+    : previous(currentAccount) {
+    currentAccount = &account;
+}
+
+Helpers::MemoryScope::~MemoryScope() {
+    currentAccount = previous;
+}
+
+Helpers::MemoryAccount* Helpers::MemoryScope::current() {
+    return currentAccount;
+}
+
+#if EASYHELPERS_MEMORY_ACCOUNTING
+void* operator new(std::size_t size) {
+    void* block = Helpers::accountedAllocate(size ? size : 1);
+    if (!block) {
+#    if defined(__cpp_exceptions)
+        throw std::bad_alloc();
+#    else
+        std::abort();
+#    endif
+    }
+    return block;
+}
+
+void* operator new[](std::size_t size) {
+    return operator new(size);
+}
+
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept {
+    return Helpers::accountedAllocate(size ? size : 1);
+}
+
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept {
+    return Helpers::accountedAllocate(size ? size : 1);
+}
+
+void operator delete(void* block) noexcept {
+    Helpers::accountedFree(block);
+}
+
+void operator delete[](void* block) noexcept {
+    Helpers::accountedFree(block);
+}
+
+void operator delete(void* block, std::size_t) noexcept {
+    Helpers::accountedFree(block);
+}
+
+void operator delete[](void* block, std::size_t) noexcept {
+    Helpers::accountedFree(block);
+}
+
+void operator delete(void* block, const std::nothrow_t&) noexcept {
+    Helpers::accountedFree(block);
+}
+
+void operator delete[](void* block, const std::nothrow_t&) noexcept {
+    Helpers::accountedFree(block);
+}
+
+//* Over-aligned types, e.g. `alignas(64)` members
+
+void* operator new(std::size_t size, std::align_val_t alignment) {
+    void* block = Helpers::accountedAllocateAligned(
+        size ? size : 1, static_cast<size_t>(alignment));
+    if (!block) {
+#    if defined(__cpp_exceptions)
+        throw std::bad_alloc();
+#    else
+        std::abort();
+#    endif
+    }
+    return block;
+}
+
+void* operator new[](std::size_t size, std::align_val_t alignment) {
+    return operator new(size, alignment);
+}
+
+void* operator new(std::size_t size, std::align_val_t alignment,
+                   const std::nothrow_t&) noexcept {
+    return Helpers::accountedAllocateAligned(size ? size : 1,
+                                             static_cast<size_t>(alignment));
+}
+
+void* operator new[](std::size_t size, std::align_val_t alignment,
+                     const std::nothrow_t&) noexcept {
+    return Helpers::accountedAllocateAligned(size ? size : 1,
+                                             static_cast<size_t>(alignment));
+}
+
+void operator delete(void* block, std::align_val_t) noexcept {
+    Helpers::accountedFreeAligned(block);
+}
+
+void operator delete[](void* block, std::align_val_t) noexcept {
+    Helpers::accountedFreeAligned(block);
+}
+
+void operator delete(void* block, std::size_t, std::align_val_t) noexcept {
+    Helpers::accountedFreeAligned(block);
+}
+
+void operator delete[](void* block, std::size_t, std::align_val_t) noexcept {
+    Helpers::accountedFreeAligned(block);
+}
+
+void operator delete(void* block, std::align_val_t,
+                     const std::nothrow_t&) noexcept {
+    Helpers::accountedFreeAligned(block);
+}
+
+void operator delete[](void* block, std::align_val_t,
+                       const std::nothrow_t&) noexcept {
+    Helpers::accountedFreeAligned(block);
+}
+#endif
@@ -0,0 +1,255 @@
+#include <helpers/message_batcher.hpp>
+#include <algorithm>
+#include <chrono>
+
+namespace {
+//* Lets ArduinoJson append to the batch instead of replacing it
+class AppendWriter {
+    std::string& out;
+
+   public:
+    explicit AppendWriter(std::string& out) : out(out) {}
+
+    size_t write(uint8_t c) {
+        out.push_back(static_cast<char>(c));
+        return 1;
+    }
+
+    size_t write(const uint8_t* data, size_t length) {
+        out.append(reinterpret_cast<const char*>(data), length);
+        return length;
+    }
+};
+
+void encodeCobs(const std::string& in, std::string& out) {
+    size_t codePosition = out.size();
+    uint8_t code = 1;
+    out.push_back(0);
+    for (char c : in) {
+        if (c != 0) {
+            out.push_back(c);
+            code++;
+        }
+        if (c == 0 || code == 0xff) {
+            out[codePosition] = static_cast<char>(code);
+            codePosition = out.size();
+            code = 1;
+            out.push_back(0);
+        }
+    }
+    out[codePosition] = static_cast<char>(code);
+    out.push_back(0);
+}
+}  // namespace
+
+Helpers::FileSink::FileSink(const std::string& path, bool append)
+    : file(std::fopen(path.c_str(), append ? "ab" : "wb")) {}
+
+Helpers::FileSink::~FileSink() {
+    if (file) {
+        std::fclose(file);
+    }
+}
+
+bool Helpers::FileSink::write(const uint8_t* data, size_t length, size_t) {
+    return file && std::fwrite(data, 1, length, file) == length &&
+           std::fflush(file) == 0;
+}
+
+uint64_t Helpers::MessageBatcher::steadyMillis() {
+    return std::chrono::duration_cast<std::chrono::milliseconds>(
+               std::chrono::steady_clock::now().time_since_epoch())
+        .count();
+}
+
+Helpers::MessageBatcher::MessageBatcher(BatchSink& sink, BatchConfig config,
+                                       Clock_t clock)
+    : mutex(xSemaphoreCreateMutex()),
+      sink(&sink),
+      config(config),
+      clock(std::move(clock)) {
+    buffer.reserve(config.maxBytes);
+}
+
+Helpers::MessageBatcher::~MessageBatcher() {
+    vSemaphoreDelete(mutex);
+}
+
+void Helpers::MessageBatcher::append(const JsonDocument& message) {
+    switch (config.framing) {
+        case FRAMING_LENGTH_PREFIXED: {
+            size_t start = buffer.size();
+            buffer.append(4, '\0');
+            AppendWriter writer(buffer);
+            size_t length = serializeJson(message, writer);
+            for (size_t i = 0; i < 4; i++) {
+                buffer[start + i] =
+                    static_cast<char>(length >> (8 * (3 - i)));
+            }
+            break;
+        }
+        case FRAMING_COBS: {
+            scratch.clear();
+            AppendWriter writer(scratch);
+            serializeJson(message, writer);
+            encodeCobs(scratch, buffer);
+            break;
+        }
+        default: {
+            AppendWriter writer(buffer);
+            serializeJson(message, writer);
+            buffer.push_back('\n');
+            break;
+        }
+    }
+}
+
+void Helpers::MessageBatcher::seal(size_t length, size_t messages,
+                                   FlushReason_e reason) {
+    Batch batch;
+    if (!spares.empty()) {
+        batch.data = std::move(spares.back());
+        spares.pop_back();
+    }
+    if (length == buffer.size()) {
+        // the whole buffer goes, take it and keep filling a spare
+        batch.data.swap(buffer);
+    } else {
+        // a message held back for the next batch stays in the buffer
+        batch.data.assign(buffer, 0, length);
+        buffer.erase(0, length);
+    }
+    batch.messages = messages;
+    ready.push_back(std::move(batch));
+    pending -= messages;
+
+    stats.batches++;
+    stats.bytes += length;
+    stats.largestBatch = std::max(stats.largestBatch, length);
+    switch (reason) {
+        case SIZE:
+            stats.bySize++;
+            break;
+        case COUNT:
+            stats.byCount++;
+            break;
+        case LINGER:
+            stats.byLinger++;
+            break;
+        case REQUEST:
+            stats.byRequest++;
+            break;
+    }
+}
+
+void Helpers::MessageBatcher::deliver() {
+    xSemaphoreTake(mutex, portMAX_DELAY);
+    // whoever is already delivering, possibly further up this very stack
+    // when a sink feeds back into `add`, writes the batch after its own
+    if (delivering) {
+        xSemaphoreGive(mutex);
+        return;
+    }
+    delivering = true;
+    while (!ready.empty()) {
+        Batch batch = std::move(ready.front());
+        ready.pop_front();
+        BatchSink* target = sink;
+        xSemaphoreGive(mutex);
+
+        bool delivered = target->write(
+            reinterpret_cast<const uint8_t*>(batch.data.data()),
+            batch.data.size(), batch.messages);
+
+        xSemaphoreTake(mutex, portMAX_DELAY);
+        stats.failed += !delivered;
+        if (spares.size() < MAX_SPARES) {
+            batch.data.clear();
+            spares.push_back(std::move(batch.data));
+        }
+    }
+    delivering = false;
+    xSemaphoreGive(mutex);
+}
+
+void Helpers::MessageBatcher::add(const JsonDocument& message) {
+    xSemaphoreTake(mutex, portMAX_DELAY);
+    // the linger is only checked by `poll`, so a short one, or 0, still
+    // lets the messages added between two polls share a batch
+    uint64_t now = clock();
+
+    size_t before = buffer.size();
+    append(message);
+    stats.messages++;
+    if (pending && buffer.size() > config.maxBytes) {
+        // the message does not fit, send the batch without it
+        seal(before, pending, SIZE);
+    }
+    if (!pending) {
+        oldest = now;
+    }
+    pending++;
+
+    if (buffer.size() >= config.maxBytes) {
+        seal(buffer.size(), pending, SIZE);
+    } else if (pending >= config.maxMessages) {
+        seal(buffer.size(), pending, COUNT);
+    }
+    bool sealed = !ready.empty();
+    xSemaphoreGive(mutex);
+    if (sealed) {
+        deliver();
+    }
+}
+
+bool Helpers::MessageBatcher::poll() {
+    xSemaphoreTake(mutex, portMAX_DELAY);
+    bool due = pending && clock() - oldest >= config.lingerMs;
+    if (due) {
+        seal(buffer.size(), pending, LINGER);
+    }
+    xSemaphoreGive(mutex);
+    if (due) {
+        deliver();
+    }
+    return due;
+}
+
+bool Helpers::MessageBatcher::flush() {
+    xSemaphoreTake(mutex, portMAX_DELAY);
+    bool any = pending > 0;
+    if (any) {
+        seal(buffer.size(), pending, REQUEST);
+    }
+    xSemaphoreGive(mutex);
+    if (any) {
+        deliver();
+    }
+    return any;
+}
+
+void Helpers::MessageBatcher::setSink(BatchSink& sink) {
+    xSemaphoreTake(mutex, portMAX_DELAY);
+    this->sink = &sink;
+    xSemaphoreGive(mutex);
+}
+
+size_t Helpers::MessageBatcher::size() {
+    xSemaphoreTake(mutex, portMAX_DELAY);
+    size_t count = pending;
+    xSemaphoreGive(mutex);
+    return count;
+}
+
+Helpers::BatchStats Helpers::MessageBatcher::getStats() {
+    xSemaphoreTake(mutex, portMAX_DELAY);
+    BatchStats copy = stats;
+    xSemaphoreGive(mutex);
+    return copy;
+}
+
+void Helpers::MessageBatcher::resetStats() {
+    xSemaphoreTake(mutex, portMAX_DELAY);
+    stats = BatchStats();
+    xSemaphoreGive(mutex);
+}
@@ -0,0 +1,132 @@
+#include <helpers/progress.hpp>
+#include <cstdio>
+
+void Helpers::appendProgressBar(std::string& out, uint64_t progress,
+                                uint64_t total, size_t width) {
+    progress = progress < total ? progress : total;
+    size_t pos = total ? static_cast<size_t>(width * progress / total) : 0;
+    out += '[';
+    for (size_t i = 0; i < width; ++i) {
+        if (i < pos)
+            out += '=';
+        else if (i == pos)
+            out += '>';
+        else
+            out += ' ';
+    }
+    out += ']';
+}
+
+Helpers::ProgressRenderer::ProgressRenderer(std::ostream& out, uint32_t maxFps,
+                                            size_t barWidth)
+    : out(out),
+      frameInterval(1000 / (maxFps ? maxFps : 1)),
+      barWidth(barWidth),
+      lastFrame(Clock_t::now() - frameInterval) {}
+
+Helpers::ProgressRenderer::~ProgressRenderer() {
+    stop();
+}
+
+std::shared_ptr<Helpers::ProgressBar> Helpers::ProgressRenderer::addBar(
+    const std::string& label, size_t total) {
+    auto bar = std::make_shared<ProgressBar>(label, total);
+    std::lock_guard<std::mutex> lock(mutex);
+    bars.push_back(bar);
+    return bar;
+}
+
+void Helpers::ProgressRenderer::removeBar(
+    const std::shared_ptr<ProgressBar>& bar) {
+    std::lock_guard<std::mutex> lock(mutex);
+    for (auto it = bars.begin(); it != bars.end(); ++it) {
+        if (*it == bar) {
+            bars.erase(it);
+            break;
+        }
+    }
+}
+
+void Helpers::ProgressRenderer::appendLine(ProgressBar& bar,
+                                           Clock_t::time_point now) {
+    uint64_t current = bar.getCurrent();
+    uint64_t total = bar.getTotal();
+
+    // exponential moving average of the rate between two frames
+    double elapsed =
+        std::chrono::duration<double>(now - bar.sampleTime).count();
+    if (elapsed > 0 && current >= bar.sampleCount) {
+        double instant = (current - bar.sampleCount) / elapsed;
+        bar.rate = bar.rate > 0 ? 0.7 * bar.rate + 0.3 * instant : instant;
+        bar.sampleTime = now;
+        bar.sampleCount = current;
+    }
+
+    char stats[96];
+    int percent = total ? static_cast<int>(current * 100 / total) : 0;
+    int written = std::snprintf(
+        stats, sizeof(stats), " %3d%% %llu/%llu %.1f/s", percent,
+        static_cast<unsigned long long>(current),
+        static_cast<unsigned long long>(total), bar.rate);
+
+    if (bar.isFinished()) {
+        std::snprintf(stats + written, sizeof(stats) - written, " done");
+    } else if (bar.rate > 0 && total > current) {
+        uint64_t eta = static_cast<uint64_t>((total - current) / bar.rate);
+        std::snprintf(stats + written, sizeof(stats) - written,
+                      " ETA %02llu:%02llu:%02llu",
+                      static_cast<unsigned long long>(eta / 3600),
+                      static_cast<unsigned long long>(eta / 60 % 60),
+                      static_cast<unsigned long long>(eta % 60));
+    }
+
+    frame += bar.label;
+    frame += ' ';
+    appendProgressBar(frame, current, total, barWidth);
+    frame += stats;
+    frame += "\x1b[K\n";  // clear leftovers of a longer previous line
+}
+
+bool Helpers::ProgressRenderer::render(bool force) {
+    std::lock_guard<std::mutex> lock(mutex);
+    auto now = Clock_t::now();
+    if (!force && now - lastFrame < frameInterval) {
+        return false;
+    }
+    lastFrame = now;
+
+    frame.clear();
+    if (linesDrawn > 0) {
+        // move back to the first line of the previous frame
+        frame += "\x1b[";
+        frame += std::to_string(linesDrawn);
+        frame += 'A';
+    }
+    for (auto& bar : bars) {
+        appendLine(*bar, now);
+    }
+    linesDrawn = bars.size();
+
+    out.write(frame.data(), frame.size());
+    out.flush();
+    return true;
+}
+
+void Helpers::ProgressRenderer::start() {
+    if (running.exchange(true)) {
+        return;
+    }
+    worker = std::thread([this]() {
+        while (running.load(std::memory_order_relaxed)) {
+            render();
+            std::this_thread::sleep_for(frameInterval);
+        }
+    });
+}
+
+void Helpers::ProgressRenderer::stop() {
+    if (running.exchange(false) && worker.joinable()) {
+        worker.join();
+        render(true);
+    }
+}
@@ -0,0 +1,408 @@
+#include <helpers/ring_log.hpp>
+#include <chrono>
+#include <cstring>
+#if defined(__linux__)
+#    include <fcntl.h>
+#    include <sys/mman.h>
+#    include <sys/stat.h>
+#    include <unistd.h>
+#endif
+
+namespace {
+constexpr uint32_t RING_LOG_MAGIC = 0x45484c47;  // "EHLG"
+constexpr uint32_t RING_LOG_VERSION = 2;
+//* Keeps the cursors, which run up to twice the capacity, in 32 bits
+constexpr uint64_t RING_LOG_MAX_CAPACITY = uint64_t(1) << 30;
+
+struct RegionHeader {
+    uint32_t magic;
+    uint32_t version;
+    uint64_t capacity;
+    //* Bytes written and discarded modulo twice the capacity, `% capacity`
+    //* gives the offset and the doubled range tells a full ring from an
+    //* empty one
+    uint32_t head;
+    uint32_t tail;
+    uint64_t nextSequence;
+    uint64_t reserved[2];
+};
+
+struct RecordHeader {
+    uint32_t length;
+    uint32_t checksum;
+    uint64_t sequence;
+    uint64_t timestampMs;
+    uint8_t level;
+    uint8_t reserved[7];
+};
+
+static_assert(sizeof(RegionHeader) == Helpers::RingLogSink::HEADER_SIZE,
+              "Unexpected region header layout");
+static_assert(sizeof(RecordHeader) == Helpers::RingLogSink::RECORD_OVERHEAD,
+              "Unexpected record header layout");
+
+uint64_t alignRecord(uint64_t size) {
+    return (size + 7) & ~uint64_t(7);
+}
+
+uint32_t fnv1a(uint32_t hash, const void* bytes, size_t length) {
+    const uint8_t* data = static_cast<const uint8_t*>(bytes);
+    for (size_t i = 0; i < length; i++) {
+        hash = (hash ^ data[i]) * 16777619u;
+    }
+    return hash;
+}
+
+uint32_t recordChecksum(RecordHeader header, const uint8_t* ring,
+                        uint64_t capacity, uint64_t offset) {
+    header.checksum = 0;
+    uint32_t hash = fnv1a(2166136261u, &header, sizeof(header));
+    uint64_t first = capacity - offset;
+    if (first >= header.length) {
+        return fnv1a(hash, ring + offset, header.length);
+    }
+    hash = fnv1a(hash, ring + offset, first);
+    return fnv1a(hash, ring, header.length - first);
+}
+
+void ringWrite(uint8_t* ring, uint64_t capacity, uint64_t position,
+               const void* bytes, size_t length) {
+    uint64_t offset = position % capacity;
+    uint64_t first = capacity - offset;
+    if (first >= length) {
+        std::memcpy(ring + offset, bytes, length);
+        return;
+    }
+    std::memcpy(ring + offset, bytes, first);
+    std::memcpy(ring, static_cast<const uint8_t*>(bytes) + first,
+                length - first);
+}
+
+void ringRead(const uint8_t* ring, uint64_t capacity, uint64_t position,
+              void* bytes, size_t length) {
+    uint64_t offset = position % capacity;
+    uint64_t first = capacity - offset;
+    if (first >= length) {
+        std::memcpy(bytes, ring + offset, length);
+        return;
+    }
+    std::memcpy(bytes, ring + offset, first);
+    std::memcpy(static_cast<uint8_t*>(bytes) + first, ring, length - first);
+}
+
+// the cursors may be read after a crash, so they are 32 bit: a single store
+// on every target, where 8 bytes would go through libatomic on the ESP32
+static_assert(__atomic_always_lock_free(sizeof(uint32_t), 0),
+              "Ring log cursors must be stored in one write");
+
+void storeCursor(uint32_t& cursor, uint64_t value) {
+    __atomic_store_n(&cursor, static_cast<uint32_t>(value), __ATOMIC_RELEASE);
+}
+
+uint64_t loadCursor(const uint32_t& cursor) {
+    return __atomic_load_n(&cursor, __ATOMIC_ACQUIRE);
+}
+
+//* Move a cursor forward by at most the capacity
+uint64_t advanceCursor(uint64_t cursor, uint64_t bytes, uint64_t capacity) {
+    cursor += bytes;
+    return cursor >= 2 * capacity ? cursor - 2 * capacity : cursor;
+}
+
+//* Bytes from `tail` to `head`
+uint64_t cursorDistance(uint64_t head, uint64_t tail, uint64_t capacity) {
+    return head >= tail ? head - tail : head + 2 * capacity - tail;
+}
+
+bool validHeader(const RegionHeader& header, size_t size) {
+    return header.magic == RING_LOG_MAGIC &&
+           header.version == RING_LOG_VERSION &&
+           header.capacity == size - sizeof(RegionHeader) &&
+           header.capacity <= RING_LOG_MAX_CAPACITY &&
+           header.head < 2 * header.capacity &&
+           header.tail < 2 * header.capacity &&
+           cursorDistance(header.head, header.tail, header.capacity) <=
+               header.capacity &&
+           header.head % 8 == 0 && header.tail % 8 == 0;
+}
+
+/**
+ * @brief Call `onRecord` for each complete, in sequence record from `tail`
+ * @return The cursor after the last valid record
+ */
+template <typename OnRecord>
+uint64_t scanRecords(const uint8_t* data, uint64_t capacity, uint64_t tail,
+                     uint64_t head, OnRecord onRecord) {
+    // walk unwrapped positions, they stay valid offsets `% capacity`
+    uint64_t position = tail;
+    head = tail + cursorDistance(head, tail, capacity);
+    bool first = true;
+    uint64_t expected = 0;
+    while (head - position >= Helpers::RingLogSink::RECORD_OVERHEAD) {
+        RecordHeader record;
+        ringRead(data, capacity, position, &record, sizeof(record));
+        uint64_t total = alignRecord(Helpers::RingLogSink::RECORD_OVERHEAD +
+                                     uint64_t(record.length));
+        if (total > head - position ||
+            (!first && record.sequence != expected) ||
+            record.checksum !=
+                recordChecksum(
+                    record, data, capacity,
+                    (position + Helpers::RingLogSink::RECORD_OVERHEAD) %
+                        capacity)) {
+            break;
+        }
+        onRecord(record, position);
+        expected = record.sequence + 1;
+        first = false;
+        position += total;
+    }
+    return advanceCursor(tail, position - tail, capacity);
+}
+
+uint64_t nowMillis() {
+    return std::chrono::duration_cast<std::chrono::milliseconds>(
+               std::chrono::system_clock::now().time_since_epoch())
+        .count();
+}
+}  // namespace
+
+//* Memory-mapped file backing a sink
+class Helpers::RingLogSink::MappedFile {
+   public:
+    void* address = nullptr;
+    size_t size = 0;
+#if defined(__linux__)
+    int fd = -1;
+
+    bool open(const std::string& path, size_t size, bool writable) {
+        fd = ::open(path.c_str(), writable ? O_RDWR | O_CREAT : O_RDONLY,
+                    0644);
+        if (fd < 0) {
+            return false;
+        }
+        struct stat status;
+        if (fstat(fd, &status) != 0) {
+            return false;
+        }
+        if (writable && static_cast<size_t>(status.st_size) != size &&
+            ftruncate(fd, size) != 0) {
+            return false;
+        }
+        this->size = writable ? size : static_cast<size_t>(status.st_size);
+        if (this->size == 0) {
+            return false;
+        }
+        void* mapped =
+            mmap(nullptr, this->size,
+                 writable ? PROT_READ | PROT_WRITE : PROT_READ, MAP_SHARED,
+                 fd, 0);
+        if (mapped == MAP_FAILED) {
+            return false;
+        }
+        address = mapped;
+        return true;
+    }
+
+    void flush() {
+        if (address) {
+            msync(address, size, MS_ASYNC);
+        }
+    }
+
+    ~MappedFile() {
+        if (address) {
+            munmap(address, size);
+        }
+        if (fd >= 0) {
+            ::close(fd);
+        }
+    }
+#else
+    void flush() {}
+#endif
+};
+
+Helpers::RingLogSink::RingLogSink(void* region, size_t size,
+                                  Overflow_e overflow)
+    : mutex(xSemaphoreCreateMutex()),
+      region(static_cast<uint8_t*>(region)),
+      data(this->region + HEADER_SIZE),
+      capacity(size > HEADER_SIZE ? size - HEADER_SIZE : 0),
+      overflow(overflow) {
+    attach();
+}
+
+Helpers::RingLogSink::RingLogSink(std::unique_ptr<MappedFile> file,
+                                  Overflow_e overflow)
+    : RingLogSink(file->address, file->size, overflow) {
+    this->file = std::move(file);
+}
+
+Helpers::RingLogSink::~RingLogSink() {
+    vSemaphoreDelete(mutex);
+}
+
+void Helpers::RingLogSink::attach() {
+    if (capacity < RECORD_OVERHEAD + 8) {
+        capacity = 0;
+        return;
+    }
+    // keep every record 8 byte aligned, including the ones that wrap around
+    if (capacity > RING_LOG_MAX_CAPACITY) {
+        capacity = RING_LOG_MAX_CAPACITY;
+    }
+    capacity &= ~uint64_t(7);
+    RegionHeader* header = reinterpret_cast<RegionHeader*>(region);
+    if (!validHeader(*header, capacity + HEADER_SIZE)) {
+        clear();
+        return;
+    }
+
+    // a reset may land between publishing the sequence and the head, so
+    // resume from the records themselves rather than from the header
+    uint64_t head = loadCursor(header->head);
+    bool any = false;
+    uint64_t last = 0;
+    uint64_t end = scanRecords(
+        data, capacity, loadCursor(header->tail), head,
+        [&](const RecordHeader& record, uint64_t) {
+            any = true;
+            last = record.sequence;
+        });
+    if (any) {
+        header->nextSequence = last + 1;
+    }
+    // drop whatever follows the last valid record, new records must follow on
+    if (end != head) {
+        storeCursor(header->head, end);
+    }
+}
+
+#if defined(__linux__)
+std::unique_ptr<Helpers::RingLogSink> Helpers::RingLogSink::openFile(
+    const std::string& path, size_t size, Overflow_e overflow) {
+    std::unique_ptr<MappedFile> file(new MappedFile());
+    if (!file->open(path, size, true)) {
+        return nullptr;
+    }
+    return std::unique_ptr<RingLogSink>(
+        new RingLogSink(std::move(file), overflow));
+}
+#endif
+
+void Helpers::RingLogSink::write(uint8_t level, const char* message,
+                                 size_t length) {
+    if (capacity == 0) {
+        droppedCount.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+    // truncate records that would not fit in the region on their own
+    if (length > capacity - RECORD_OVERHEAD) {
+        length = capacity - RECORD_OVERHEAD;
+    }
+    uint64_t total = alignRecord(RECORD_OVERHEAD + length);
+
+    RegionHeader* header = reinterpret_cast<RegionHeader*>(region);
+    xSemaphoreTake(mutex, portMAX_DELAY);
+    uint64_t head = header->head;
+    uint64_t tail = header->tail;
+    if (cursorDistance(head, tail, capacity) + total > capacity) {
+        if (overflow == DROP_NEWEST) {
+            xSemaphoreGive(mutex);
+            droppedCount.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+        // discard the oldest records before overwriting them
+        while (cursorDistance(head, tail, capacity) + total > capacity) {
+            RecordHeader oldest;
+            ringRead(data, capacity, tail, &oldest, sizeof(oldest));
+            tail = advanceCursor(
+                tail, alignRecord(RECORD_OVERHEAD + oldest.length), capacity);
+        }
+        storeCursor(header->tail, tail);
+    }
+
+    RecordHeader record{};
+    record.length = static_cast<uint32_t>(length);
+    record.sequence = header->nextSequence;
+    record.timestampMs = nowMillis();
+    record.level = level;
+    ringWrite(data, capacity, head + RECORD_OVERHEAD, message, length);
+    record.checksum = recordChecksum(record, data, capacity,
+                                     (head + RECORD_OVERHEAD) % capacity);
+    ringWrite(data, capacity, head, &record, sizeof(record));
+
+    // publish the record only once it is complete
+    header->nextSequence = record.sequence + 1;
+    storeCursor(header->head, advanceCursor(head, total, capacity));
+    xSemaphoreGive(mutex);
+}
+
+void Helpers::RingLogSink::flush() {
+    if (file) {
+        file->flush();
+    }
+}
+
+void Helpers::RingLogSink::clear() {
+    if (capacity == 0) {
+        return;
+    }
+    RegionHeader* header = reinterpret_cast<RegionHeader*>(region);
+    xSemaphoreTake(mutex, portMAX_DELAY);
+    header->magic = 0;
+    header->version = RING_LOG_VERSION;
+    header->capacity = capacity;
+    header->nextSequence = 0;
+    header->reserved[0] = 0;
+    header->reserved[1] = 0;
+    storeCursor(header->head, 0);
+    storeCursor(header->tail, 0);
+    __atomic_store_n(&header->magic, RING_LOG_MAGIC, __ATOMIC_RELEASE);
+    xSemaphoreGive(mutex);
+}
+
+std::vector<Helpers::LogRecord> Helpers::recoverRingLog(const void* region,
+                                                        size_t size) {
+    std::vector<LogRecord> records;
+    if (size < RingLogSink::HEADER_SIZE) {
+        return records;
+    }
+    RegionHeader header;
+    std::memcpy(&header, region, sizeof(header));
+    header.head = loadCursor(static_cast<const RegionHeader*>(region)->head);
+    header.tail = loadCursor(static_cast<const RegionHeader*>(region)->tail);
+    // the sink may have trimmed an unaligned size
+    if (header.capacity > size - RingLogSink::HEADER_SIZE ||
+        header.capacity + 8 <= size - RingLogSink::HEADER_SIZE ||
+        !validHeader(header, header.capacity + RingLogSink::HEADER_SIZE)) {
+        return records;
+    }
+
+    const uint8_t* data =
+        static_cast<const uint8_t*>(region) + RingLogSink::HEADER_SIZE;
+    uint64_t capacity = header.capacity;
+    scanRecords(data, capacity, header.tail, header.head,
+                [&](const RecordHeader& record, uint64_t position) {
+                    LogRecord recovered{record.sequence, record.timestampMs,
+                                        record.level,
+                                        std::string(record.length, '\0')};
+                    ringRead(data, capacity,
+                             position + RingLogSink::RECORD_OVERHEAD,
+                             &recovered.message[0], record.length);
+                    records.push_back(std::move(recovered));
+                });
+    return records;
+}
+
+#if defined(__linux__)
+std::vector<Helpers::LogRecord> Helpers::recoverRingLog(
+    const std::string& path) {
+    Helpers::RingLogSink::MappedFile file;
+    if (!file.open(path, 0, false)) {
+        return {};
+    }
+    return recoverRingLog(file.address, file.size);
+}
+#endif
@@ -0,0 +1,68 @@
+#include <helpers/task_graph.hpp>
+#include <algorithm>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+
+std::vector<size_t> Helpers::TaskGraph::run(
+    const std::function<void(size_t)>& task, size_t workers) {
+    std::vector<size_t> remaining = dependencyCount;
+    std::vector<bool> done(size(), false);
+    std::deque<size_t> ready;
+    for (size_t i = 0; i < size(); i++) {
+        if (remaining[i] == 0) {
+            ready.push_back(i);
+        }
+    }
+
+    std::mutex mutex;
+    std::condition_variable changed;
+    size_t running = 0;
+
+    auto work = [&]() {
+        std::unique_lock<std::mutex> lock(mutex);
+        while (true) {
+            changed.wait(lock,
+                         [&]() { return !ready.empty() || running == 0; });
+            if (ready.empty()) {
+                // nothing is running that could make more tasks ready
+                return;
+            }
+            size_t next = ready.front();
+            ready.pop_front();
+            running++;
+            lock.unlock();
+
+            task(next);
+
+            lock.lock();
+            running--;
+            done[next] = true;
+            for (size_t dependent : dependents[next]) {
+                if (--remaining[dependent] == 0) {
+                    ready.push_back(dependent);
+                }
+            }
+            changed.notify_all();
+        }
+    };
+
+    std::vector<std::thread> pool;
+    size_t threads = std::min(workers, size());
+    for (size_t i = 1; i < threads; i++) {
+        pool.emplace_back(work);
+    }
+    work();
+    for (auto& thread : pool) {
+        thread.join();
+    }
+
+    std::vector<size_t> blocked;
+    for (size_t i = 0; i < size(); i++) {
+        if (!done[i]) {
+            blocked.push_back(i);
+        }
+    }
+    return blocked;
+}
@@ -0,0 +1,32 @@
+#pragma once
+#include <chrono>
+#include <mutex>
+#include "FreeRTOS.h"
+
+//! Mutexes on top of `std::timed_mutex`, one tick is a millisecond.
+
+typedef std::timed_mutex* SemaphoreHandle_t;
+
+inline SemaphoreHandle_t xSemaphoreCreateMutex() {
+    return new std::timed_mutex();
+}
+
+inline void vSemaphoreDelete(SemaphoreHandle_t semaphore) {
+    delete semaphore;
+}
+
+inline BaseType_t xSemaphoreTake(SemaphoreHandle_t semaphore,
+                                 TickType_t ticks) {
+    if (ticks == portMAX_DELAY) {
+        semaphore->lock();
+        return pdTRUE;
+    }
+    return semaphore->try_lock_for(std::chrono::milliseconds(ticks))
+               ? pdTRUE
+               : pdFALSE;
+}
+
+inline BaseType_t xSemaphoreGive(SemaphoreHandle_t semaphore) {
+    semaphore->unlock();
+    return pdTRUE;
+}
@@ -0,0 +1,246 @@
+#include <helpers/frame_parser.hpp>
+#include <cstdint>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+//! Fuzzes `FrameParser::feed` on the host. As a Unity test, run with
+//! `pio test -e native`, it feeds seeded random streams split at random
+//! points. Built with `-DEASYHELPERS_LIBFUZZER` it is a libFuzzer target
+//! instead:
+//!
+//!   clang++ -std=gnu++17 -g -fsanitize=fuzzer,address,undefined
+//!       -DEASYHELPERS_LIBFUZZER -Iinclude test/test_frame_parser/test_main.cpp
+
+using Helpers::FrameParser;
+using Helpers::MessageFraming_t;
+
+namespace {
+
+//* xorshift, so failures reproduce from the seed
+class Random {
+    uint32_t state;
+
+   public:
+    explicit Random(uint32_t seed) : state(seed ? seed : 1) {}
+
+    uint32_t next() {
+        state ^= state << 13;
+        state ^= state >> 17;
+        state ^= state << 5;
+        return state;
+    }
+
+    size_t below(size_t bound) {
+        return bound ? next() % bound : 0;
+    }
+};
+
+void encodeCobs(const std::string& frame, std::string& out) {
+    size_t code = out.size();
+    out.push_back(1);
+    for (char byte : frame) {
+        if (byte == 0) {
+            code = out.size();
+            out.push_back(1);
+            continue;
+        }
+        out.push_back(byte);
+        if (++out[code] == static_cast<char>(0xFF)) {
+            code = out.size();
+            out.push_back(1);
+        }
+    }
+    out.push_back(0);
+}
+
+void encode(MessageFraming_t framing, const std::string& frame,
+            std::string& out) {
+    switch (framing) {
+        case Helpers::FRAMING_NDJSON:
+            out += frame;
+            out += '\n';
+            break;
+        case Helpers::FRAMING_LENGTH_PREFIXED: {
+            uint32_t length = frame.size();
+            out.push_back(static_cast<char>(length >> 24));
+            out.push_back(static_cast<char>(length >> 16));
+            out.push_back(static_cast<char>(length >> 8));
+            out.push_back(static_cast<char>(length));
+            out += frame;
+            break;
+        }
+        case Helpers::FRAMING_COBS:
+            encodeCobs(frame, out);
+            break;
+    }
+}
+
+//* A frame every framing carries unchanged: NDJSON lines cannot hold a
+//* newline or end in `\r`, and no framing delivers empty frames
+std::string randomFrame(Random& random, MessageFraming_t framing,
+                        size_t maxLength) {
+    std::string frame(1 + random.below(maxLength), '\0');
+    for (char& byte : frame) {
+        byte = static_cast<char>(random.next());
+        if (framing == Helpers::FRAMING_NDJSON &&
+            (byte == '\n' || byte == '\r')) {
+            byte = 'x';
+        }
+    }
+    return frame;
+}
+
+/**
+ * @brief Feed `stream` in chunks cut at the given points and check the
+ * parser's invariants
+ * @return The frames delivered
+ */
+std::vector<std::string> feedSplit(FrameParser& parser, const char* stream,
+                                   size_t length,
+                                   const std::vector<size_t>& cuts,
+                                   size_t& errors) {
+    std::vector<std::string> frames;
+    size_t maxFrameSize = parser.getMaxFrameSize();
+    size_t start = 0;
+    for (size_t i = 0; i <= cuts.size(); i++) {
+        size_t end = i < cuts.size() ? cuts[i] : length;
+        if (end < start || end > length) {
+            continue;
+        }
+        parser.feed(
+            stream + start, end - start,
+            [&](const char* frame, size_t frameLength) {
+                if (frameLength == 0 || frameLength > maxFrameSize) {
+                    std::abort();
+                }
+                frames.emplace_back(frame, frameLength);
+            },
+            [&](FrameParser::Error_e, size_t offset) {
+                if (offset > end) {
+                    std::abort();
+                }
+                errors++;
+            });
+        if (parser.buffered() > maxFrameSize) {
+            std::abort();
+        }
+        start = end;
+    }
+    return frames;
+}
+
+const MessageFraming_t framings[] = {Helpers::FRAMING_NDJSON,
+                                     Helpers::FRAMING_LENGTH_PREFIXED,
+                                     Helpers::FRAMING_COBS};
+}  // namespace
+
+#ifdef EASYHELPERS_LIBFUZZER
+
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size) {
+    if (size < 2) {
+        return 0;
+    }
+    // the first byte picks the framing and limit, the second seeds the cuts
+    MessageFraming_t framing = framings[data[0] % 3];
+    FrameParser parser(framing, 1 + (data[0] >> 2) * 8);
+    Random random(data[1]);
+    const char* stream = reinterpret_cast<const char*>(data + 2);
+    size -= 2;
+    std::vector<size_t> cuts;
+    for (size_t cut = random.below(16); cut < size;
+         cut += 1 + random.below(64)) {
+        cuts.push_back(cut);
+    }
+    size_t errors = 0;
+    feedSplit(parser, stream, size, cuts, errors);
+    return 0;
+}
+
+#else
+#    include <unity.h>
+
+void setUp() {}
+
+void tearDown() {}
+
+void test_frames_survive_any_split() {
+    Random random(0x5eed);
+    for (MessageFraming_t framing : framings) {
+        for (int round = 0; round < 200; round++) {
+            std::vector<std::string> frames;
+            std::string stream;
+            size_t count = 1 + random.below(8);
+            for (size_t i = 0; i < count; i++) {
+                frames.push_back(randomFrame(random, framing, 600));
+                encode(framing, frames.back(), stream);
+            }
+            std::vector<size_t> cuts;
+            for (size_t cut = random.below(32); cut < stream.size();
+                 cut += 1 + random.below(48)) {
+                cuts.push_back(cut);
+            }
+
+            FrameParser parser(framing, 600);
+            size_t errors = 0;
+            std::vector<std::string> parsed = feedSplit(
+                parser, stream.data(), stream.size(), cuts, errors);
+            TEST_ASSERT_EQUAL_size_t(0, errors);
+            TEST_ASSERT_EQUAL_size_t(frames.size(), parsed.size());
+            for (size_t i = 0; i < frames.size(); i++) {
+                TEST_ASSERT_TRUE(frames[i] == parsed[i]);
+            }
+        }
+    }
+}
+
+void test_oversized_frames_are_dropped() {
+    for (MessageFraming_t framing : framings) {
+        std::string stream;
+        encode(framing, std::string(100, 'a'), stream);
+        encode(framing, std::string(20, 'b'), stream);
+
+        FrameParser parser(framing, 50);
+        size_t errors = 0;
+        std::vector<std::string> parsed =
+            feedSplit(parser, stream.data(), stream.size(), {7, 60}, errors);
+        TEST_ASSERT_EQUAL_size_t(1, errors);
+        TEST_ASSERT_EQUAL_size_t(1, parser.oversized());
+        TEST_ASSERT_EQUAL_size_t(1, parsed.size());
+        TEST_ASSERT_TRUE(parsed[0] == std::string(20, 'b'));
+    }
+}
+
+void test_garbage_keeps_invariants() {
+    Random random(0xfeed);
+    for (MessageFraming_t framing : framings) {
+        for (int round = 0; round < 500; round++) {
+            std::string stream(random.below(2048), '\0');
+            for (char& byte : stream) {
+                // bias towards the bytes the framings treat specially
+                uint32_t pick = random.next();
+                byte = pick % 4 == 0 ? "\n\r\0\xFF"[pick / 4 % 4]
+                                     : static_cast<char>(pick >> 8);
+            }
+            std::vector<size_t> cuts;
+            for (size_t cut = random.below(16); cut < stream.size();
+                 cut += 1 + random.below(128)) {
+                cuts.push_back(cut);
+            }
+            FrameParser parser(framing, 1 + random.below(256));
+            size_t errors = 0;
+            feedSplit(parser, stream.data(), stream.size(), cuts, errors);
+            TEST_ASSERT_EQUAL_size_t(errors,
+                                     parser.oversized() + parser.malformed());
+        }
+    }
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_frames_survive_any_split);
+    RUN_TEST(test_oversized_frames_are_dropped);
+    RUN_TEST(test_garbage_keeps_invariants);
+    return UNITY_END();
+}
+#endif
@@ -0,0 +1,175 @@
+#include <helpers/memory_accounting.hpp>
+#include <malloc.h>
+#include <unity.h>
+#include <atomic>
+#include <cerrno>
+#include <memory>
+#include <string>
+#include <vector>
+
+//! Checks the accounting against the heap itself: malloc and friends are
+//! interposed, every accounted allocation must be one malloc call, every
+//! live block one live malloc block, and the live bytes must match up to the
+//! block headers. Needs glibc and `-DEASYHELPERS_MEMORY_ACCOUNTING=1`, see
+//! `[env:native]`.
+
+extern "C" {
+void* __libc_malloc(size_t size);
+void* __libc_realloc(void* block, size_t size);
+void* __libc_calloc(size_t count, size_t size);
+void* __libc_memalign(size_t alignment, size_t size);
+void __libc_free(void* block);
+}
+
+namespace {
+std::atomic<uint64_t> mallocCalls{0};
+std::atomic<uint64_t> freeCalls{0};
+std::atomic<int64_t> mallocBytes{0};
+}  // namespace
+
+extern "C" void* malloc(size_t size) {
+    void* block = __libc_malloc(size);
+    if (block) {
+        mallocCalls++;
+        mallocBytes += malloc_usable_size(block);
+    }
+    return block;
+}
+
+extern "C" void* calloc(size_t count, size_t size) {
+    void* block = __libc_calloc(count, size);
+    if (block) {
+        mallocCalls++;
+        mallocBytes += malloc_usable_size(block);
+    }
+    return block;
+}
+
+//* Used by an unaccounted aligned operator new, which would show up as extra
+//* malloc calls
+extern "C" void* aligned_alloc(size_t alignment, size_t size) {
+    void* block = __libc_memalign(alignment, size);
+    if (block) {
+        mallocCalls++;
+        mallocBytes += malloc_usable_size(block);
+    }
+    return block;
+}
+
+extern "C" int posix_memalign(void** block, size_t alignment, size_t size) {
+    *block = aligned_alloc(alignment, size);
+    return *block ? 0 : ENOMEM;
+}
+
+extern "C" void* realloc(void* block, size_t size) {
+    int64_t previous = block ? malloc_usable_size(block) : 0;
+    void* resized = __libc_realloc(block, size);
+    if (resized) {
+        mallocCalls += !block;
+        mallocBytes += malloc_usable_size(resized) - previous;
+    }
+    return resized;
+}
+
+extern "C" void free(void* block) {
+    if (block) {
+        freeCalls++;
+        mallocBytes -= malloc_usable_size(block);
+    }
+    __libc_free(block);
+}
+
+//* Over-aligned, allocated through the aligned operator new
+struct alignas(64) Cursor {
+    uint64_t position = 0;
+};
+
+struct Owner {
+    EASYHELPERS_MEMORY_ACCOUNT_CACHE(memory);
+
+    std::vector<int> fill() {
+        EASYHELPERS_MEMORY_SCOPE_CACHED(memory, "Owner", this);
+        return std::vector<int>(64);
+    }
+};
+
+std::vector<int>* leaked = nullptr;
+
+void workload() {
+    EASYHELPERS_MEMORY_SCOPE("Sensors", "bme280");
+    std::vector<std::string> readings;
+    for (int i = 0; i < 32; i++) {
+        readings.push_back("temperature reading number " + std::to_string(i));
+    }
+    std::unique_ptr<Cursor> cursor(new Cursor());
+    leaked = new std::vector<int>(100);  // still live after the scope
+}
+
+void setUp() {}
+
+void tearDown() {}
+
+void test_accounting_matches_malloc() {
+    Helpers::MemoryAccount& total = Helpers::memoryTotal();
+    // warm up the account, so the registry does not allocate mid check
+    Helpers::memoryAccount("Sensors", "bme280");
+
+    uint64_t calls = mallocCalls, frees = freeCalls;
+    int64_t bytes = mallocBytes;
+    uint64_t allocations = total.getAllocations();
+    uint64_t deallocations = total.getDeallocations();
+    int64_t current = total.getCurrentBytes();
+
+    workload();
+
+    uint64_t callDelta = mallocCalls - calls;
+    uint64_t liveBlocks = callDelta - (freeCalls - frees);
+    int64_t liveBytes = mallocBytes - bytes;
+    uint64_t accounted = total.getAllocations() - allocations;
+    uint64_t accountedLive =
+        accounted - (total.getDeallocations() - deallocations);
+    int64_t accountedBytes = total.getCurrentBytes() - current;
+
+    TEST_ASSERT_EQUAL_UINT64(callDelta, accounted);
+    TEST_ASSERT_EQUAL_UINT64(liveBlocks, accountedLive);
+    // headers and malloc rounding make the heap larger, by a bounded amount
+    TEST_ASSERT_TRUE(liveBytes >= accountedBytes);
+    TEST_ASSERT_TRUE(liveBytes <=
+                     accountedBytes + static_cast<int64_t>(liveBlocks) * 128);
+    delete leaked;
+}
+
+void test_scope_charges_named_instance() {
+    Helpers::MemoryAccount& sensor =
+        Helpers::memoryAccount("Sensors", "bme280");
+    int64_t before = sensor.getCurrentBytes();
+    workload();
+    size_t charged = sizeof(*leaked) + leaked->capacity() * sizeof(int);
+    TEST_ASSERT_EQUAL_INT64(before + static_cast<int64_t>(charged),
+                            sensor.getCurrentBytes());
+    delete leaked;
+    TEST_ASSERT_EQUAL_INT64(before, sensor.getCurrentBytes());
+}
+
+void test_cached_scope_charges_owner() {
+    Owner owner;
+    Helpers::MemoryAccount& account =
+        Helpers::memoryAccount("Owner", Helpers::memoryInstance(&owner));
+    uint64_t allocations = account.getAllocations();
+    std::vector<int> first = owner.fill();
+    std::vector<int> second = owner.fill();
+    TEST_ASSERT_EQUAL_UINT64(allocations + 2, account.getAllocations());
+
+    // a copy is another instance, with an account of its own
+    Owner copy = owner;
+    std::vector<int> copied = copy.fill();
+    TEST_ASSERT_EQUAL_UINT64(allocations + 2, account.getAllocations());
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_accounting_matches_malloc);
+    RUN_TEST(test_scope_charges_named_instance);
+    RUN_TEST(test_cached_scope_charges_owner);
+    return UNITY_END();
+}
@@ -0,0 +1,146 @@
+#include <helpers/message_batcher.hpp>
+#include <unity.h>
+#include <cstring>
+#include <string>
+#include <vector>
+
+//! Checks when `MessageBatcher` seals its batches, against a manual clock,
+//! and that every framing reads back through `deserializeBatch`.
+
+using Helpers::BatchConfig;
+using Helpers::MessageBatcher;
+
+namespace {
+
+enum class EventID { NewMessage, EVENT_1 };
+
+class RecordingSink : public Helpers::BatchSink {
+   public:
+    std::vector<std::string> batches;
+    std::vector<size_t> counts;
+    bool fail = false;
+
+    bool write(const uint8_t* data, size_t length, size_t messages) override {
+        batches.emplace_back(reinterpret_cast<const char*>(data), length);
+        counts.push_back(messages);
+        return !fail;
+    }
+};
+
+uint64_t now = 0;
+
+uint64_t manualClock() {
+    return now;
+}
+
+JsonDocument message(int i) {
+    std::string json = "{\"i\":" + std::to_string(i) + "}";
+    JsonDocument doc;
+    deserializeJson(doc, json.data(), json.size());
+    return doc;
+}
+}  // namespace
+
+void setUp() {
+    now = 0;
+}
+
+void tearDown() {}
+
+void test_zero_linger_batches_between_polls() {
+    RecordingSink sink;
+    MessageBatcher batcher(sink, {1024, 16, 0}, manualClock);
+    for (int i = 0; i < 3; i++) {
+        batcher.add(message(i));
+    }
+    TEST_ASSERT_EQUAL_size_t(0, sink.batches.size());
+
+    TEST_ASSERT_TRUE(batcher.poll());
+    TEST_ASSERT_EQUAL_size_t(1, sink.batches.size());
+    TEST_ASSERT_EQUAL_size_t(3, sink.counts[0]);
+    TEST_ASSERT_EQUAL_STRING("{\"i\":0}\n{\"i\":1}\n{\"i\":2}\n",
+                             sink.batches[0].c_str());
+    TEST_ASSERT_FALSE(batcher.poll());
+}
+
+void test_linger_flushes_only_from_poll() {
+    RecordingSink sink;
+    MessageBatcher batcher(sink, {1024, 16, 10}, manualClock);
+    batcher.add(message(0));
+    now = 5;
+    TEST_ASSERT_FALSE(batcher.poll());
+    now = 20;
+    batcher.add(message(1));
+    TEST_ASSERT_EQUAL_size_t(0, sink.batches.size());
+
+    TEST_ASSERT_TRUE(batcher.poll());
+    TEST_ASSERT_EQUAL_size_t(1, sink.batches.size());
+    TEST_ASSERT_EQUAL_size_t(2, sink.counts[0]);
+    TEST_ASSERT_EQUAL_UINT64(1, batcher.getStats().byLinger);
+}
+
+void test_size_holds_back_the_overflowing_message() {
+    RecordingSink sink;
+    // each message takes 8 bytes with its newline
+    MessageBatcher batcher(sink, {20, 16, 10}, manualClock);
+    for (int i = 0; i < 3; i++) {
+        batcher.add(message(i));
+    }
+    TEST_ASSERT_EQUAL_size_t(1, sink.batches.size());
+    TEST_ASSERT_EQUAL_STRING("{\"i\":0}\n{\"i\":1}\n", sink.batches[0].c_str());
+    TEST_ASSERT_EQUAL_size_t(1, batcher.size());
+    TEST_ASSERT_EQUAL_UINT64(1, batcher.getStats().bySize);
+
+    TEST_ASSERT_TRUE(batcher.flush());
+    TEST_ASSERT_EQUAL_STRING("{\"i\":2}\n", sink.batches[1].c_str());
+}
+
+void test_count_seals_the_batch() {
+    RecordingSink sink;
+    MessageBatcher batcher(sink, {1024, 2, 10}, manualClock);
+    for (int i = 0; i < 5; i++) {
+        batcher.add(message(i));
+    }
+    TEST_ASSERT_EQUAL_size_t(2, sink.batches.size());
+    TEST_ASSERT_EQUAL_size_t(1, batcher.size());
+    TEST_ASSERT_EQUAL_UINT64(2, batcher.getStats().byCount);
+}
+
+void test_failed_writes_are_counted() {
+    RecordingSink sink;
+    sink.fail = true;
+    MessageBatcher batcher(sink, {1024, 16, 10}, manualClock);
+    batcher.add(message(0));
+    TEST_ASSERT_TRUE(batcher.flush());
+    TEST_ASSERT_EQUAL_UINT64(1, batcher.getStats().failed);
+    TEST_ASSERT_FALSE(batcher.flush());
+}
+
+void test_framings_read_back() {
+    const Helpers::MessageFraming_t framings[] = {
+        Helpers::FRAMING_NDJSON, Helpers::FRAMING_LENGTH_PREFIXED,
+        Helpers::FRAMING_COBS};
+    for (Helpers::MessageFraming_t framing : framings) {
+        Helpers::MessageBuffer<EventID> inbox;
+        Helpers::LoopbackSink<EventID> loopback(inbox, framing);
+        MessageBatcher batcher(loopback, {1024, 16, 10, framing},
+                               manualClock);
+        for (int i = 0; i < 3; i++) {
+            batcher.add(message(i));
+        }
+        TEST_ASSERT_TRUE(batcher.flush());
+        TEST_ASSERT_EQUAL_UINT64(0, batcher.getStats().failed);
+        TEST_ASSERT_EQUAL_size_t(3, inbox.size());
+    }
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_zero_linger_batches_between_polls);
+    RUN_TEST(test_linger_flushes_only_from_poll);
+    RUN_TEST(test_size_holds_back_the_overflowing_message);
+    RUN_TEST(test_count_seals_the_batch);
+    RUN_TEST(test_failed_writes_are_counted);
+    RUN_TEST(test_framings_read_back);
+    return UNITY_END();
+}
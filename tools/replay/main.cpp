@@ -0,0 +1,92 @@
+#include <events/event_replay.hpp>
+#include <cstdio>
+#include <cstdlib>
+#include <map>
+#include <memory>
+
+//! Replays a recording file on the host and prints the ReplayReport.
+//!
+//!   pio run -e native_replay
+//!   .pio/build/native_replay/program field.rec [speed]
+//!
+//! The speed defaults to 0, as fast as possible, 1 keeps the recorded pace.
+//! Every recorded subject is replayed into a strategy that drains its
+//! messages, so the report measures the library rather than the application.
+
+namespace {
+
+//* Wide enough for any recorded event value
+enum class ReplayEvent : int64_t { NewMessage };
+
+class Sink : public Helpers::IEvent<ReplayEvent> {
+   public:
+    uint64_t received = 0;
+
+    void receiveMessage() override {
+        while (this->getMessage()) {
+            received++;
+        }
+    }
+};
+
+class Manager : public Helpers::CustomEventManager<ReplayEvent> {
+   public:
+    using Helpers::CustomEventManager<ReplayEvent>::CustomEventManager;
+
+    void update(const ReplayEvent&) override {}
+};
+
+void printReport(const Helpers::ReplayReport& report) {
+    std::printf(
+        "records       %llu\n"
+        "messages      %llu\n"
+        "notifications %llu\n"
+        "skipped       %llu\n"
+        "seconds       %.3f\n"
+        "records/s     %.0f\n"
+        "latency us    p50 %.1f, p90 %.1f, p99 %.1f, p99.9 %.1f, max %.1f\n",
+        (unsigned long long)report.records,
+        (unsigned long long)report.messages,
+        (unsigned long long)report.notifications,
+        (unsigned long long)report.skipped, report.seconds,
+        report.recordsPerSecond, report.latencyP50, report.latencyP90,
+        report.latencyP99, report.latencyP999, report.latencyMax);
+}
+}  // namespace
+
+int main(int argc, char** argv) {
+    if (argc < 2) {
+        std::fprintf(stderr, "usage: %s <recording> [speed]\n", argv[0]);
+        return 2;
+    }
+    Helpers::RecordingReader reader{std::string(argv[1])};
+    if (!reader.good()) {
+        std::fprintf(stderr, "%s is not a recording\n", argv[1]);
+        return 1;
+    }
+    double speed = argc > 2 ? std::atof(argv[2]) : 0;
+
+    Helpers::VirtualClock clock;
+    auto manager = std::make_shared<Manager>("Replay", clock.millisClock());
+    // a sink per recorded subject, created on its first record
+    std::map<uint64_t, std::shared_ptr<Sink> > sinks;
+    Helpers::EventReplayer<ReplayEvent> replayer(
+        *manager, clock,
+        [&](uint64_t id) -> Helpers::ISubject<ReplayEvent>* {
+            auto& sink = sinks[id];
+            if (!sink) {
+                sink = std::make_shared<Sink>();
+                sink->setID(id);
+                manager->addSubscriber(sink);
+            }
+            return sink.get();
+        });
+
+    printReport(replayer.replay(reader, speed));
+    for (auto& [id, sink] : sinks) {
+        std::printf("subject %llu received %llu messages\n",
+                    (unsigned long long)id,
+                    (unsigned long long)sink->received);
+    }
+    return 0;
+}